@@ -0,0 +1,56 @@
+/** 
+ *  @file   crc.h
+ *  @author Adom Kwabena
+ *  @brief  A driver for the CRC calculation unit of the stm32f407vgt6
+ *          microcontroller.
+ * 
+ *          The unit computes the CRC-32 (Ethernet polynomial 0x04C11DB7)
+ *          of a stream of 32-bit words, one word every 4 AHB clock cycles.
+ */
+
+// Prevent multiple file inclusion.
+#ifndef     __CRC_INC__
+#define     __CRC_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+
+// ****************************************************************************
+// * Function Prototypes
+// ****************************************************************************
+
+/**
+ *  @brief   Enables the CRC calculation unit.
+ *  @param   None.
+ *  @returns None.
+ */
+void crc_init(void);
+
+/**
+ *  @brief   Resets the CRC calculation unit to its initial value
+ *           (0xFFFFFFFF).
+ *  @param   None.
+ *  @returns None.
+ */
+void crc_reset(void);
+
+/**
+ *  @brief   Feeds words into the CRC calculation unit without resetting it.
+ *  @param   words: The address of the words, it should be word aligned.
+ *  @param   count: The number of words.
+ *  @returns The CRC of all words fed since the last reset.
+ */
+uint32_t crc_accumulate(const uint32_t * words, uint32_t count);
+
+/**
+ *  @brief   Computes the CRC of a block of words.
+ *  @param   words: The address of the words, it should be word aligned.
+ *  @param   count: The number of words.
+ *  @returns The CRC of the block.
+ */
+uint32_t crc_compute(const uint32_t * words, uint32_t count);
+
+#endif
@@ -0,0 +1,79 @@
+/** 
+ *  @file   dma2.h
+ *  @author Adom Kwabena
+ *  @brief  A driver for memory to memory transfers on the DMA2 controller
+ *          of the stm32f407vgt6 microcontroller.
+ * 
+ *          Only DMA2 can do memory to memory transfers. This driver fills
+ *          word aligned memory with a repeated 32-bit pattern, so the CPU
+ *          is free while large buffers are cleared. The memory has to be
+ *          reachable by the DMA (SRAM, not CCM).
+ */
+
+// Prevent multiple file inclusion.
+#ifndef     __DMA2_INC__
+#define     __DMA2_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// DMA stream and interrupt flags used for memory to memory transfers.
+// Stream 0 is used by the FSMC and stream 3 by SPI1_TX.
+#define DMA2_M2M_STREAM          DMA2_Stream1
+#define DMA2_M2M_ISR             DMA2->LISR
+#define DMA2_M2M_IFCR            DMA2->LIFCR
+#define DMA2_M2M_TC_FLAG         DMA_LISR_TCIF1
+#define DMA2_M2M_TE_FLAG         DMA_LISR_TEIF1
+#define DMA2_M2M_CLEAR_FLAGS     (DMA_LIFCR_CTCIF1  | DMA_LIFCR_CHTIF1 | \
+                                  DMA_LIFCR_CTEIF1  | DMA_LIFCR_CDMEIF1 | \
+                                  DMA_LIFCR_CFEIF1)
+
+// The maximum number of words a single DMA transfer can move.
+#define DMA2_M2M_MAX_TRANSFER    65535UL
+
+// Memory below this address (flash, CCM RAM) cannot be reached by the DMA.
+#define DMA2_M2M_MEMORY_START    0x20000000UL
+
+// ****************************************************************************
+// * Function Prototypes
+// ****************************************************************************
+
+/**
+ *  @brief   Configures DMA2 stream 1 for memory to memory fills.
+ *  @param   None.
+ *  @returns None.
+ */
+void dma2_init(void);
+
+/**
+ *  @brief   Starts filling words with a pattern, without waiting for the
+ *           fill to complete.
+ *  @param   words: The address of the first word, it should be word aligned.
+ *  @param   pattern: The pattern written to every word.
+ *  @param   count: The number of words (up to DMA2_M2M_MAX_TRANSFER).
+ *  @returns None.
+ */
+void dma2_fill_words(uint32_t * words, uint32_t pattern, uint32_t count);
+
+/**
+ *  @brief   Checks if a fill is in progress.
+ *  @param   None.
+ *  @returns 1 if a fill is in progress, 0 otherwise.
+ */
+uint8_t dma2_busy(void);
+
+/**
+ *  @brief   Waits for the fill in progress to complete.
+ *  @param   None.
+ *  @returns None.
+ */
+void dma2_wait(void);
+
+#endif
@@ -0,0 +1,154 @@
+/** 
+ *  @file   fsmc.h
+ *  @author Adom Kwabena
+ *  @brief  A driver for the FSMC module of the stm32f407vgt6 microcontroller.
+ * 
+ *          This driver drives an 8-bit 8080 style parallel display bus as
+ *          memory mapped writes to FSMC bank 1 (NOR/SRAM 1). Address line
+ *          A16 selects between the command (A16 = 0) and data (A16 = 1)
+ *          registers of the display.
+ */
+
+// Prevent multiple file inclusion.
+#ifndef     __FSMC_INC__
+#define     __FSMC_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// Memory mapped display registers in FSMC bank 1 (NE1).
+// The bus is 8 bits wide so HADDR[16] drives A16 directly.
+#define FSMC_COMMAND_ADDRESS     ((volatile uint8_t *) 0x60000000UL)
+#define FSMC_DATA_ADDRESS        ((volatile uint8_t *) 0x60010000UL)
+
+// Bus timings in HCLK cycles (6.25ns at 160MHz).
+// These respect the 8080 write / read cycle time of the SSD1322 (300ns).
+#define FSMC_ADDRESS_SETUP       15UL
+#define FSMC_DATA_SETUP          32UL
+#define FSMC_BUS_TURNAROUND      1UL
+
+// DMA stream, channel and interrupt flags used for memory to FSMC transfers.
+// Only DMA2 can do memory to memory transfers.
+#define FSMC_DMA                 DMA2
+#define FSMC_DMA_STREAM          DMA2_Stream0
+#define FSMC_DMA_CHANNEL         0UL
+#define FSMC_DMA_IRQ             DMA2_Stream0_IRQn
+#define FSMC_DMA_ISR             FSMC_DMA->LISR
+#define FSMC_DMA_IFCR            FSMC_DMA->LIFCR
+#define FSMC_DMA_TC_FLAG         DMA_LISR_TCIF0
+#define FSMC_DMA_TE_FLAG         DMA_LISR_TEIF0
+#define FSMC_DMA_CLEAR_FLAGS     (DMA_LIFCR_CTCIF0  | DMA_LIFCR_CHTIF0 | \
+                                  DMA_LIFCR_CTEIF0  | DMA_LIFCR_CDMEIF0 | \
+                                  DMA_LIFCR_CFEIF0)
+
+// The maximum number of bytes a single DMA transfer can move.
+#define FSMC_DMA_MAX_TRANSFER    65535UL
+
+// ****************************************************************************
+// * Module Data Structures
+// ****************************************************************************
+
+// Function called (from interrupt context) when a DMA transfer completes.
+typedef void (*fsmc_callback_t)(void);
+
+// ****************************************************************************
+// * Function Prototypes
+// ****************************************************************************
+
+/**
+ *  @brief   Initializes the FSMC as an 8-bit 8080 parallel display bus and
+ *           the DMA stream used for bulk transfers.
+ *
+ *  @note    The FSMC pins are shared with the discovery board LEDs
+ *           (PD14, PD15) and USART2 (PD5).
+ *
+ *  @param   None.
+ *  @returns None.
+ */
+void fsmc_init(void);
+
+/**
+ *  @brief   Writes a byte to the command register of the display.
+ *  @param   command: The command to be written.
+ *  @returns None.
+ */
+void fsmc_write_command(uint8_t command);
+
+/**
+ *  @brief   Writes a byte to the data register of the display.
+ *  @param   data: The data to be written.
+ *  @returns None.
+ */
+void fsmc_write_data(uint8_t data);
+
+/**
+ *  @brief   Reads a byte from the data register of the display.
+ *  @param   None.
+ *  @returns The byte read.
+ */
+uint8_t fsmc_read_data(void);
+
+/**
+ *  @brief   Writes a buffer of bytes to the data register of the display.
+ *  @param   buffer: The address of the data to be written.
+ *  @param   buffer_size: The number of bytes to be written.
+ *  @returns None.
+ */
+void fsmc_write_data_buffer(const uint8_t * buffer, uint32_t buffer_size);
+
+/**
+ *  @brief   Writes the same byte to the data register of the display
+ *           "count" times.
+ *  @param   data: The data to be written.
+ *  @param   count: The number of times the data is written.
+ *  @returns None.
+ */
+void fsmc_write_data_repeat(uint8_t data, uint32_t count);
+
+/**
+ *  @brief   Starts a memory to FSMC DMA transfer of a buffer of bytes to the
+ *           data register of the display and returns immediately.
+ *
+ *  @note    The buffer must not live in CCM RAM and must not be modified
+ *           until the transfer completes.
+ *
+ *  @param   buffer: The address of the data to be written.
+ *  @param   buffer_size: The number of bytes to be written,
+ *                        at most FSMC_DMA_MAX_TRANSFER.
+ *  @param   callback: Function called from interrupt context once the
+ *                     transfer completes, may be NULL.
+ *  @returns None.
+ */
+void fsmc_write_data_buffer_dma(const uint8_t * buffer, uint32_t buffer_size,
+                                fsmc_callback_t callback);
+
+/**
+ *  @brief   Starts a memory to FSMC DMA transfer of the same byte repeated
+ *           "count" times and returns immediately.
+ *
+ *  @param   data: The address of the byte to be written, it must remain
+ *                 valid until the transfer completes.
+ *  @param   count: The number of times the byte is written,
+ *                  at most FSMC_DMA_MAX_TRANSFER.
+ *  @param   callback: Function called from interrupt context once the
+ *                     transfer completes, may be NULL.
+ *  @returns None.
+ */
+void fsmc_write_data_repeat_dma(const uint8_t * data, uint32_t count,
+                                fsmc_callback_t callback);
+
+/**
+ *  @brief   Checks if a DMA transfer is still in progress.
+ *  @param   None.
+ *  @returns 1 if a transfer is in progress, 0 otherwise.
+ */
+uint8_t fsmc_dma_busy(void);
+
+#endif
@@ -4,7 +4,10 @@
  *  @brief  A driver for the SPI1 module of the stm32f407vgt6 microcontroller.
  * 
  *          This driver implements blocking routines for receiving and
- *          transmitting data via the SPI1 peripheral.
+ *          transmitting data via the SPI1 peripheral, as well as a
+ *          non-blocking DMA routine for transmitting large buffers.
+ *          Where no DMA stream is available, a TXE interrupt driven queue
+ *          of tagged segments provides non-blocking transmissions.
  */
 
 // Prevent multiple file inclusion.
@@ -27,10 +30,51 @@
 #define SPI_MODE_2      0xC3
 #define SPI_MODE_3      0xD4
 
+// Possible SPI data frame formats
+#define SPI_FRAME_8BIT  8U
+#define SPI_FRAME_16BIT 16U
+
 // This macro aids in porting this driver to other SPI instances on the chip,
 // this is because all SPI instances share the same register set.
 #define SPI_INSTANCE SPI1
 
+// DMA stream, channel and interrupt flags connected to SPI1_TX.
+// SPI1_TX is available on DMA2 stream 3 channel 3 (or stream 5 channel 3).
+// All DMA register accesses go through these macros, so the driver can be
+// pointed at another stream or at a mocked register block in a host build
+// (see tests/mock).
+#define SPI_TX_DMA               DMA2
+#define SPI_TX_DMA_STREAM        DMA2_Stream3
+#define SPI_TX_DMA_CHANNEL       3UL
+#define SPI_TX_DMA_IRQ           DMA2_Stream3_IRQn
+#define SPI_TX_DMA_ISR           SPI_TX_DMA->LISR
+#define SPI_TX_DMA_IFCR          SPI_TX_DMA->LIFCR
+#define SPI_TX_DMA_TC_FLAG       DMA_LISR_TCIF3
+#define SPI_TX_DMA_TE_FLAG       DMA_LISR_TEIF3
+#define SPI_TX_DMA_CLEAR_FLAGS   (DMA_LIFCR_CTCIF3  | DMA_LIFCR_CHTIF3 | \
+                                  DMA_LIFCR_CTEIF3  | DMA_LIFCR_CDMEIF3 | \
+                                  DMA_LIFCR_CFEIF3)
+
+// The maximum number of items a single DMA transfer can move.
+#define SPI_DMA_MAX_TRANSFER     65535UL
+
+// Number of segments held by the transmit queue, must be a power of 2
+#define SPI_QUEUE_SIZE           32UL
+// Number of bytes a segment can hold without referencing a buffer
+#define SPI_QUEUE_INLINE_SIZE    8UL
+
+// Transmit queue segment tags
+// COMMAND - bytes are sent with the data / command line low
+// DATA    - bytes are sent with the data / command line high
+// RELEASE - chip select is released once the previous bytes are shifted out
+// NOTIFY  - a callback is invoked once the previous bytes are shifted out
+#define SPI_SEGMENT_COMMAND      0x00
+#define SPI_SEGMENT_DATA         0x01
+#define SPI_SEGMENT_RELEASE      0x02
+#define SPI_SEGMENT_NOTIFY       0x03
+// Added to COMMAND or DATA to send the first byte "length" times
+#define SPI_SEGMENT_REPEAT       0x80
+
 // This macro is used to transmit data via the spi1_transceive command.
 #define spi1_transmit(x)   spi1_transceive((x))
 
@@ -38,6 +82,27 @@
 // Dummy data is transmitted to facilitate data reception.
 #define spi1_receive()     spi1_transceive(0x00)
 
+// ****************************************************************************
+// * Module Data Structures
+// ****************************************************************************
+
+// Function called (from interrupt context) when a DMA transfer completes.
+typedef void (*spi1_callback_t)(void);
+
+// Function driving a select line of the transmit queue.
+// Chip select: 1 - asserted, 0 - released.
+// Data / command: 1 - data, 0 - command.
+typedef void (*spi1_line_t)(uint8_t level);
+
+// Transmit queue statistics
+typedef struct
+{
+    // Largest number of segments queued at once
+    uint32_t high_water;
+    // Number of segments which had to wait for a free slot
+    uint32_t stalls;
+} spi1_queue_stats_t;
+
 // ****************************************************************************
 // * Function Prototypes.
 // ****************************************************************************
@@ -56,6 +121,23 @@ void spi1_init(uint8_t mode);
  */
 uint8_t spi1_transceive(uint8_t data);
 
+/**
+ *  @brief   Transmits 8 bits of data via the SPI1 peripheral without waiting
+ *           for the data to be received or shifted out. Call
+ *           "spi1_wait_idle()" before changing any select lines.
+ *  @param   data: 8-bit wide data to be transmitted.
+ *  @returns None.
+ */
+void spi1_write(uint8_t data);
+
+/**
+ *  @brief   Waits for all pending transmissions to be shifted out and clears
+ *           the overrun flag raised by write only transfers.
+ *  @param   None.
+ *  @returns None.
+ */
+void spi1_wait_idle(void);
+
 /**
  *  @brief   Transmits a buffer of 8-bit data via the SPI1 peripheral.
  *  @param   buffer: The address of the data to be transmitted.
@@ -81,4 +163,240 @@ void spi1_receive_buffer(uint8_t * buffer, uint32_t buffer_size);
 void spi1_transceive_buffer(uint8_t * tx_buffer, uint8_t * rx_buffer,
                             uint32_t buffer_size);
 
-#endif
\ No newline at end of file
+/**
+ *  @brief   Selects the data frame format of SPI1. The SPI1 module is briefly
+ *           disabled, so pending transmissions are shifted out first.
+ *           Nothing is done if the format is already selected.
+ *
+ *  @note    All 8-bit routines require SPI_FRAME_8BIT, the "16" routines
+ *           require SPI_FRAME_16BIT.
+ *
+ *  @param   frame_format: SPI_FRAME_8BIT or SPI_FRAME_16BIT.
+ *  @returns None.
+ */
+void spi1_set_frame_format(uint8_t frame_format);
+
+/**
+ *  @brief   Transmits 16 bits of data via the SPI1 peripheral without
+ *           waiting for the data to be shifted out, MSB first.
+ *  @param   data: 16-bit wide data to be transmitted.
+ *  @returns None.
+ */
+void spi1_write16(uint16_t data);
+
+/**
+ *  @brief   Transmits a buffer of bytes as 16-bit frames. Bytes are sent in
+ *           buffer order, so the result on the wire is the same as
+ *           "spi1_transmit_buffer()" with half the stores and polls.
+ *  @param   buffer: The address of the data to be transmitted.
+ *  @param   frame_count: The number of 16-bit frames (byte pairs) to be
+ *                        transmitted.
+ *  @returns None.
+ */
+void spi1_transmit_buffer16(const uint8_t * buffer, uint32_t frame_count);
+
+/**
+ *  @brief   Transmits the same 16-bit frame repeatedly via the SPI1
+ *           peripheral without reading back any data.
+ *  @param   data: 16-bit wide data to be transmitted.
+ *  @param   count: The number of times the data is transmitted.
+ *  @returns None.
+ */
+void spi1_transmit_repeat16(uint16_t data, uint32_t count);
+
+/**
+ *  @brief   Initializes the DMA stream used for SPI1 transmissions.
+ *  @pre     "spi1_init()" should be called before this function.
+ *  @param   None.
+ *  @returns None.
+ */
+void spi1_dma_init(void);
+
+/**
+ *  @brief   Starts a DMA transmission of a buffer of 8-bit data via the SPI1
+ *           peripheral and returns immediately. Received data is discarded.
+ *
+ *  @note    The buffer must not live in CCM RAM since the DMA controller has
+ *           no access to it. The buffer must not be modified until the
+ *           transfer completes.
+ *
+ *  @param   buffer: The address of the data to be transmitted.
+ *  @param   buffer_size: The number of bytes to be transmitted,
+ *                        at most SPI_DMA_MAX_TRANSFER.
+ *  @param   callback: Function called from interrupt context once the last
+ *                     byte has been shifted out, may be NULL.
+ *  @returns None.
+ */
+void spi1_transmit_buffer_dma(const uint8_t * buffer, uint32_t buffer_size,
+                              spi1_callback_t callback);
+
+/**
+ *  @brief   Transmits the same byte of data repeatedly via the SPI1 peripheral
+ *           without reading back any data.
+ *  @param   data: 8-bit wide data to be transmitted.
+ *  @param   count: The number of times the data is transmitted.
+ *  @returns None.
+ */
+void spi1_transmit_repeat(uint8_t data, uint32_t count);
+
+/**
+ *  @brief   Starts a DMA transmission of the same byte of data repeated
+ *           "count" times via the SPI1 peripheral and returns immediately.
+ *           The memory address is not incremented during the transfer.
+ *
+ *  @note    The data must not live in CCM RAM and must remain valid until
+ *           the transfer completes.
+ *
+ *  @param   data: The address of the byte to be transmitted.
+ *  @param   count: The number of times the byte is transmitted,
+ *                  at most SPI_DMA_MAX_TRANSFER.
+ *  @param   callback: Function called from interrupt context once the last
+ *                     byte has been shifted out, may be NULL.
+ *  @returns None.
+ */
+void spi1_transmit_repeat_dma(const uint8_t * data, uint32_t count,
+                              spi1_callback_t callback);
+
+/**
+ *  @brief   Checks if a DMA transmission is still in progress.
+ *  @param   None.
+ *  @returns 1 if a transfer is in progress, 0 otherwise.
+ */
+uint8_t spi1_dma_busy(void);
+
+/**
+ *  @brief   Checks if the last DMA transmission failed. The callback of a
+ *           failed transmission is still invoked, it can check this flag.
+ *           The flag is cleared when the next transmission starts.
+ *  @param   None.
+ *  @returns 1 if the transmission ended with a transfer error, 0 otherwise.
+ */
+uint8_t spi1_dma_error(void);
+
+/**
+ *  @brief   Starts a DMA transmission of a buffer of 16-bit frames via the
+ *           SPI1 peripheral and returns immediately. Each halfword is sent
+ *           MSB first, so a byte buffer has to be byte swapped (__REV16) to
+ *           keep its byte order on the wire.
+ *
+ *  @note    The buffer must be halfword aligned, must not live in CCM RAM
+ *           and must not be modified until the transfer completes.
+ *
+ *  @param   buffer: The address of the data to be transmitted.
+ *  @param   frame_count: The number of 16-bit frames to be transmitted,
+ *                        at most SPI_DMA_MAX_TRANSFER.
+ *  @param   callback: Function called from interrupt context once the last
+ *                     frame has been shifted out, may be NULL.
+ *  @returns None.
+ */
+void spi1_transmit_buffer16_dma(const uint16_t * buffer, uint32_t frame_count,
+                                spi1_callback_t callback);
+
+/**
+ *  @brief   Starts a DMA transmission of the same 16-bit frame repeated
+ *           "count" times via the SPI1 peripheral and returns immediately.
+ *
+ *  @note    The data must be halfword aligned, must not live in CCM RAM and
+ *           must remain valid until the transfer completes.
+ *
+ *  @param   data: The address of the frame to be transmitted.
+ *  @param   count: The number of times the frame is transmitted,
+ *                  at most SPI_DMA_MAX_TRANSFER.
+ *  @param   callback: Function called from interrupt context once the last
+ *                     frame has been shifted out, may be NULL.
+ *  @returns None.
+ */
+void spi1_transmit_repeat16_dma(const uint16_t * data, uint32_t count,
+                                spi1_callback_t callback);
+
+/**
+ *  @brief   Initializes the TXE interrupt driven transmit queue. The queue
+ *           drives chip select and data / command through the given
+ *           functions, asserting chip select before the first byte.
+ *
+ *  @pre     "spi1_init()" should be called before this function.
+ *  @note    The queue sends 8-bit frames and must not be mixed with the
+ *           blocking or DMA routines while it is busy.
+ *
+ *  @param   select: Function driving the chip select line.
+ *  @param   data_command: Function driving the data / command line.
+ *  @returns None.
+ */
+void spi1_queue_init(spi1_line_t select, spi1_line_t data_command);
+
+/**
+ *  @brief   Queues a buffer of bytes and returns, the buffer is referenced
+ *           and must remain valid until it has been sent.
+ *  @param   tag: SPI_SEGMENT_COMMAND or SPI_SEGMENT_DATA.
+ *  @param   buffer: The address of the data to be transmitted.
+ *  @param   length: The number of bytes to be transmitted.
+ *  @returns None.
+ */
+void spi1_queue_push(uint8_t tag, const uint8_t * buffer, uint32_t length);
+
+/**
+ *  @brief   Queues a copy of a few bytes and returns, so the bytes may be
+ *           reused immediately. Every SPI_QUEUE_INLINE_SIZE bytes take up
+ *           a segment.
+ *  @param   tag: SPI_SEGMENT_COMMAND or SPI_SEGMENT_DATA.
+ *  @param   bytes: The address of the data to be transmitted.
+ *  @param   length: The number of bytes to be transmitted.
+ *  @returns None.
+ */
+void spi1_queue_push_copy(uint8_t tag, const uint8_t * bytes, uint32_t length);
+
+/**
+ *  @brief   Queues the same byte repeated "count" times and returns.
+ *  @param   tag: SPI_SEGMENT_COMMAND or SPI_SEGMENT_DATA.
+ *  @param   data: The byte to be transmitted.
+ *  @param   count: The number of times the byte is transmitted.
+ *  @returns None.
+ */
+void spi1_queue_push_repeat(uint8_t tag, uint8_t data, uint32_t count);
+
+/**
+ *  @brief   Queues the release of chip select and returns.
+ *  @param   callback: Function called from interrupt context once chip
+ *                     select is released, may be NULL.
+ *  @returns None.
+ */
+void spi1_queue_release(spi1_callback_t callback);
+
+/**
+ *  @brief   Queues a notification and returns.
+ *  @param   callback: Function called from interrupt context once all bytes
+ *                     queued before it have been shifted out.
+ *  @returns None.
+ */
+void spi1_queue_notify(spi1_callback_t callback);
+
+/**
+ *  @brief   Checks if the transmit queue still holds segments.
+ *  @param   None.
+ *  @returns 1 if segments are pending, 0 otherwise.
+ */
+uint8_t spi1_queue_busy(void);
+
+/**
+ *  @brief   Waits for the transmit queue to drain and the last byte to be
+ *           shifted out.
+ *  @param   None.
+ *  @returns None.
+ */
+void spi1_queue_flush(void);
+
+/**
+ *  @brief   Reads the transmit queue statistics.
+ *  @param   stats: Where the statistics are stored.
+ *  @returns None.
+ */
+void spi1_queue_get_stats(spi1_queue_stats_t * stats);
+
+/**
+ *  @brief   Clears the transmit queue statistics.
+ *  @param   None.
+ *  @returns None.
+ */
+void spi1_queue_reset_stats(void);
+
+#endif
@@ -0,0 +1,72 @@
+/** 
+ *  @file   tim2.h
+ *  @author Adom Kwabena
+ *  @brief  A driver for the TIM2 general purpose timer of the stm32f407vgt6
+ *          microcontroller.
+ * 
+ *          The timer runs as a periodic tick with an update interrupt. Its
+ *          32-bit counter is clocked without a prescaler, so periods are
+ *          resolved to a single timer clock (50ns).
+ */
+
+// Prevent multiple file inclusion.
+#ifndef     __TIM2_INC__
+#define     __TIM2_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+
+// ****************************************************************************
+// * Definitions and Macros.
+// ****************************************************************************
+
+// TIM2 kernel clock. APB1 runs at 10MHz with a prescaler other than 1, so
+// the timers on it are clocked at twice that.
+#define TIM2_CLOCK_HZ       20000000UL
+
+// ****************************************************************************
+// * Module Data Structures
+// ****************************************************************************
+
+// Function called (from interrupt context) on every timer tick.
+typedef void (*tim2_callback_t)(void);
+
+// ****************************************************************************
+// * Function Prototypes
+// ****************************************************************************
+
+/**
+ *  @brief   Starts the timer ticking with a period.
+ *  @param   period_ns: The tick period in nanoseconds.
+ *  @param   callback: Function called on every tick.
+ *  @returns None.
+ */
+void tim2_start(uint32_t period_ns, tim2_callback_t callback);
+
+/**
+ *  @brief   Changes the tick period, the new period starts with the next
+ *           tick so the phase of the ticks is kept.
+ *  @param   period_ns: The tick period in nanoseconds.
+ *  @returns None.
+ */
+void tim2_set_period(uint32_t period_ns);
+
+/**
+ *  @brief   Restarts the current period now, moving the phase of the
+ *           ticks to this moment.
+ *  @param   None.
+ *  @returns None.
+ */
+void tim2_restart(void);
+
+/**
+ *  @brief   Stops the timer ticking.
+ *  @param   None.
+ *  @returns None.
+ */
+void tim2_stop(void);
+
+#endif
@@ -14,22 +14,101 @@
 
 #include <stdint.h>
 #include "delay.h"
-#include "stm32f407xx.h"
 
 // ****************************************************************************
-// * Definitions and Macros
+// * Driver Configuration
 // ****************************************************************************
 
-// Hardware abstraction for GPIO
-// Use PORTA pin 0 as chip select pin
-#define CHIP_SELECT_HIGH()                      GPIOA->BSRR = GPIO_BSRR_BS_0
-#define CHIP_SELECT_LOW()                       GPIOA->BSRR = GPIO_BSRR_BR_0
-// Use PORTA pin 1 as data / command pin
-#define DATA_COMMAND_HIGH()                     GPIOA->BSRR = GPIO_BSRR_BS_1
-#define DATA_COMMAND_LOW()                      GPIOA->BSRR = GPIO_BSRR_BR_1
-// Use PORTA pin 2 as chip reset pin
-#define CHIP_RESET_HIGH()                       GPIOA->BSRR = GPIO_BSRR_BS_2
-#define CHIP_RESET_LOW()                        GPIOA->BSRR = GPIO_BSRR_BR_2
+// Buses the SSD1322 can be connected through
+// SPI - 4-wire serial interface on SPI1
+// FSMC - 8-bit 8080 parallel interface on FSMC bank 1
+// HOST - memory sink used to test the driver on a host
+// SPI_IRQ - 4-wire serial interface on SPI1 driven by TXE interrupts
+#define SSD1322_BUS_SPI                         0
+#define SSD1322_BUS_FSMC                        1
+#define SSD1322_BUS_HOST                        2
+#define SSD1322_BUS_SPI_IRQ                     3
+
+// Default bus used to talk to the SSD1322.
+// This selects the transport used until ssd1322_set_transport() is called.
+#ifndef SSD1322_BUS
+#define SSD1322_BUS                             SSD1322_BUS_SPI
+#endif
+
+// Host builds run the driver on the build machine against the memory sink.
+// The cycle counter, CRC unit, DMA2 and reset delays of the Cortex-M4 are
+// replaced by portable code, durations reported in CPU cycles are reported
+// in nanoseconds instead.
+#ifndef SSD1322_HOST_BUILD
+#if SSD1322_BUS == SSD1322_BUS_HOST
+#define SSD1322_HOST_BUILD                      1
+#else
+#define SSD1322_HOST_BUILD                      0
+#endif
+#endif
+
+// DMA capable transports fill GDDRAM windows using DMA (1)
+// or a write only polling loop (0)
+#ifndef SSD1322_FILL_USE_DMA
+#define SSD1322_FILL_USE_DMA                    1
+#endif
+
+// Frame buffer fills of at least this many bytes are done by DMA2 memory
+// to memory transfers, 0 keeps every fill on the CPU. Host builds have no
+// DMA controller. The threshold is untuned, it has not been measured on
+// hardware yet.
+#ifndef SSD1322_FB_FILL_DMA_BYTES
+#if SSD1322_HOST_BUILD
+#define SSD1322_FB_FILL_DMA_BYTES               0U
+#else
+#define SSD1322_FB_FILL_DMA_BYTES               1024U
+#endif
+#endif
+
+// SPI transports send bulk data as 16-bit frames (1) or as bytes (0).
+// Commands and asynchronous DMA buffer transfers are always sent as bytes.
+#ifndef SSD1322_SPI_16BIT_DATA
+#define SSD1322_SPI_16BIT_DATA                  1
+#endif
+
+// Number of dirty rectangles tracked for partial flushes
+#ifndef SSD1322_DIRTY_RECTS
+#define SSD1322_DIRTY_RECTS                     4U
+#endif
+
+// Number of frame buffer bytes hashed together by content-diff flushes,
+// a multiple of 4 which divides BUFFER_WIDTH
+#ifndef SSD1322_DIFF_SEGMENT_BYTES
+#define SSD1322_DIFF_SEGMENT_BYTES              32U
+#endif
+
+// Cost of programming an address window, in frame buffer bytes. Content-diff
+// flushes resend unchanged bytes when that is cheaper than a new window.
+#ifndef SSD1322_WINDOW_COST_BYTES
+#define SSD1322_WINDOW_COST_BYTES               24U
+#endif
+
+// Nominal oscillator frequency at the lowest and highest settings of the
+// display clock, used to estimate refresh rates. The frequency is taken
+// as linear in between. The defaults give the 80 Hz measured with the
+// initialization settings, calibrate them for accurate estimates.
+#ifndef SSD1322_OSC_MIN_HZ
+#define SSD1322_OSC_MIN_HZ                      1000000UL
+#endif
+
+#ifndef SSD1322_OSC_MAX_HZ
+#define SSD1322_OSC_MAX_HZ                      1341440UL
+#endif
+
+// Display clocks of the current drive phase of a row, part of each row
+// time next to the phase 1 and phase 2 lengths.
+#ifndef SSD1322_CURRENT_DRIVE_DCLKS
+#define SSD1322_CURRENT_DRIVE_DCLKS             112U
+#endif
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
 
 // SSD1322 commands
 #define ENABLE_GRAY_SCALE_TABLE                 0x00
@@ -65,10 +144,73 @@
 #define GDDRAM_WIDTH                            240U
 #define GDDRAM_HEIGHT                           128U
 
+// GDDRAM address ranges
+// A column address selects 4 pixels (2 bytes)
+#define GDDRAM_COLUMN_END                       0x77
+#define GDDRAM_ROW_END                          0x7F
+
 // Dimensions of physical display in pixels
 #define DISPLAY_WIDTH                           256U
 #define DISPLAY_HEIGHT                          64U
 
+// GDDRAM columns mapped to the physical display.
+// There is a horizontal offset of 28 (pixels start from segment 112)
+#define DISPLAY_COLUMN_START                    0x1C
+#define DISPLAY_COLUMN_END                      0x5B
+// Number of column addresses mapped to the physical display
+#define DISPLAY_COLUMNS                         (DISPLAY_COLUMN_END - DISPLAY_COLUMN_START + 1)
+
+// The display is centred in the GDDRAM, so mirroring the column addresses
+// (REMAP_COLUMN) maps it onto the same column addresses
+_Static_assert((GDDRAM_COLUMN_END - DISPLAY_COLUMN_END) == DISPLAY_COLUMN_START,
+               "the display must be centred in the GDDRAM columns");
+
+// Re-map format bits (first parameter of SET_REMAP_DUAL_COM_LINE_MODE)
+// COLUMN - column address 0 mapped to SEG479 instead of SEG0
+// NIBBLE - the two pixels of each byte are swapped
+// COM_SCAN - scan from COM[N-1] to COM0
+#define REMAP_COLUMN                            0x02
+#define REMAP_NIBBLE                            0x04
+#define REMAP_COM_SCAN                          0x10
+// Re-map format of a panel mounted the right way up
+#define REMAP_DEFAULT                           (REMAP_NIBBLE | REMAP_COM_SCAN)
+
+// Display orientations, they may be combined
+// MIRROR_X - mirrored left to right
+// MIRROR_Y - mirrored top to bottom
+// ROTATE_180 - rotated by 180 degrees (mirrored both ways)
+// NIBBLE_SWAP - frame buffers with the two pixels of each byte swapped
+#define ORIENTATION_NORMAL                      0x00
+#define ORIENTATION_MIRROR_X                    0x01
+#define ORIENTATION_MIRROR_Y                    0x02
+#define ORIENTATION_ROTATE_180                  (ORIENTATION_MIRROR_X | ORIENTATION_MIRROR_Y)
+#define ORIENTATION_NIBBLE_SWAP                 0x04
+
+// Segment output current set by "ssd1322_initialize()"
+#define DEFAULT_CONTRAST_CURRENT                0x9F
+#define DEFAULT_MASTER_CURRENT                  0x0F
+
+// Gray scale table definitions
+// The table holds the pulse widths (in DCLKs) of gray levels 1 to 15, gray
+// level 0 has no pulse. The datasheet specifies ascending entries up to
+// GRAY_SCALE_MAX.
+#define GRAY_SCALE_TABLE_SIZE                   15U
+#define GRAY_SCALE_MAX                          0xB4
+
+// Options for selecting the display mode
+// ALL_OFF - every pixel at gray level 0
+// ALL_ON - every pixel at gray level 15
+// NORMAL - pixels show the GDDRAM
+// INVERSE - pixels show the GDDRAM with gray levels swapped (GS0 <-> GS15)
+#define DISPLAY_MODE_ALL_OFF                    0x00
+#define DISPLAY_MODE_ALL_ON                     0x01
+#define DISPLAY_MODE_NORMAL                     0x02
+#define DISPLAY_MODE_INVERSE                    0x03
+
+// Limits of the number of rows scanned (multiplex ratio + 1)
+#define MULTIPLEX_ROWS_MIN                      16U
+#define MULTIPLEX_ROWS_MAX                      128U
+
 // Options for turning display on or off
 #define DISPLAY_ON                              0x01
 #define DISPLAY_OFF                             0x00
@@ -98,9 +240,32 @@
 #define BUFFER_HEIGHT                           64U
 #define BUFFER_SIZE                             8192U
 
+// Maximum number of bytes held by a command stream
+#define SSD1322_STREAM_SIZE                     64U
+
 // Drawing definitions
 #define ALIGN_RIGHT                             0U
 #define ALIGN_LEFT                              1U
+
+// Blend modes of resources drawn into frame buffers
+// COPY - resource pixels replace the frame buffer pixels
+// OR / XOR - gray levels are combined bitwise
+// MAX - the brighter of the two gray levels is kept
+// ADD - gray levels are added, saturating at 15
+// ALPHA - resource pixels are mixed over the frame buffer with the blend
+//         alpha, pixels of the transparent key level are left out
+#define BLEND_COPY                              0U
+#define BLEND_OR                                1U
+#define BLEND_XOR                               2U
+#define BLEND_MAX                               3U
+#define BLEND_ADD                               4U
+#define BLEND_ALPHA                             5U
+
+// Bits per pixel of surfaces
+#define SURFACE_BPP                             4U
+
+// Gray level used to pad immediate mode drawing to whole column addresses
+#define IMMEDIATE_BACKGROUND                    0x00
 #define CHAR_SPACING                            2U
 
 
@@ -136,10 +301,151 @@ typedef struct
     uint8_t height;
 } bitmap_t;
 
+// Command stream - a sequence of commands and their parameters which is
+// sent to the SSD1322 with a single chip select assertion.
+typedef struct
+{
+    uint8_t bytes[SSD1322_STREAM_SIZE];
+    // Bit n is set if bytes[n] is a command, otherwise it is data
+    uint8_t command_mask[SSD1322_STREAM_SIZE / 8];
+    uint8_t length;
+} ssd1322_stream_t;
+
+// Region of the frame buffer, columns are SSD1322 column addresses
+// (4 pixels, 2 bytes) relative to the display and rows are pixels.
+// Both ends are inclusive.
+typedef struct
+{
+    uint8_t column_start;
+    uint8_t column_end;
+    uint8_t row_start;
+    uint8_t row_end;
+} ssd1322_rect_t;
+
+// Statistics of the last content-diff flush
+typedef struct
+{
+    uint32_t rows_sent;
+    uint32_t rows_skipped;
+    uint32_t windows;
+    uint32_t bytes_sent;
+} ssd1322_diff_stats_t;
+
+// Vertical scroll state. The 128 GDDRAM rows and the frame buffer rows
+// are both used as rings, so a scroll step only uploads the rows exposed.
+typedef struct
+{
+    // Frame buffer mirroring the displayed rows
+    uint8_t * fb;
+    // Frame buffer row holding the top displayed row
+    uint8_t fb_row;
+    // GDDRAM row displayed at the top
+    uint8_t start_line;
+} ssd1322_scroll_t;
+
+// Function called (from interrupt context) when an asynchronous
+// frame buffer transfer completes.
+typedef void (*ssd1322_callback_t)(void);
+
+// Bus interface used by the driver, defined in ssd1322_transport.h
+typedef struct ssd1322_transport ssd1322_transport_t;
+
+// Pair of frame buffers used for double buffered rendering.
+// The front buffer is owned by the display and may be in flight,
+// the back buffer is owned by the application.
+typedef struct
+{
+    uint8_t * front;
+    uint8_t * back;
+} ssd1322_fb_pair_t;
+
+// Refresh profile - the scan timing of the panel.
+// The frame rate is Fosc / (D * K * rows), where D is the clock divide
+// ratio, K the display clocks of a row and rows the number scanned.
+typedef struct
+{
+    // Set Front Clock Divider value: oscillator frequency in bits [7:4],
+    // divide ratio (D = 2^n) in bits [3:0]
+    uint8_t display_clock;
+    // Set Phase Length value: phase 1 in bits [3:0], phase 2 in bits [7:4]
+    uint8_t phase_length;
+    // Number of rows scanned from the display start line
+    // (MULTIPLEX_ROWS_MIN - MULTIPLEX_ROWS_MAX)
+    uint8_t multiplex_rows;
+    // Set to show only the rows partial_start to partial_end, the other
+    // rows are turned off
+    uint8_t partial;
+    uint8_t partial_start;
+    uint8_t partial_end;
+} ssd1322_refresh_profile_t;
+
+// Estimated scan timing of a refresh profile
+typedef struct
+{
+    // Frames per second, in hundredths
+    uint32_t frame_rate_centihz;
+    // Time to scan one row, in nanoseconds
+    uint32_t row_time_ns;
+} ssd1322_refresh_info_t;
+
+// Surface - a rectangle of 4-bit pixels drawn into by the ssd1322_surface_*
+// functions. Rows are found through a table of row pointers, so a view
+// into part of another surface shares its pixels and its row table.
+typedef struct
+{
+    // Row pointers, the first is the top row of the surface
+    uint8_t **rows;
+    // Byte offset of the surface within each row
+    uint16_t x_byte;
+    // Width in pixels (even) and height in rows
+    uint16_t width;
+    uint8_t  height;
+    // Bytes between the start of two rows
+    uint16_t stride;
+    uint8_t  bpp;
+    // Rectangle drawing is clipped to, inclusive
+    int16_t  clip_x_start;
+    int16_t  clip_x_end;
+    int16_t  clip_y_start;
+    int16_t  clip_y_end;
+    // Set by "ssd1322_surface_init_fb()" and inherited by views, drawing is
+    // then recorded as dirty at the byte column and row offsets below
+    uint8_t  track_dirty;
+    uint8_t  fb_column;
+    uint8_t  fb_row;
+} ssd1322_surface_t;
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Gray scale tables for "ssd1322_set_gray_scale_table()"
+// linear - evenly spaced pulse widths over the full range
+// gamma - gamma 2.2 pulse widths for perceptually even steps
+extern const uint8_t ssd1322_gray_table_linear[GRAY_SCALE_TABLE_SIZE];
+extern const uint8_t ssd1322_gray_table_gamma[GRAY_SCALE_TABLE_SIZE];
+
+// Refresh profiles for "ssd1322_set_refresh_profile()"
+// default - the initialization settings, 64 rows at about 80 Hz
+// fast - the clock divider bypassed, about 160 Hz for fast animations
+// idle - the clock divided by 4, about 40 Hz for mostly static screens
+extern const ssd1322_refresh_profile_t ssd1322_profile_default;
+extern const ssd1322_refresh_profile_t ssd1322_profile_fast;
+extern const ssd1322_refresh_profile_t ssd1322_profile_idle;
+
 // ****************************************************************************
 // * Module APIs
 // ****************************************************************************
 
+/**
+ * @brief   Selects the bus used to talk to the SSD1322 chip.
+ *          This should be called before "ssd1322_initialize()".
+ *
+ * @param   transport: A pointer to the transport to use.
+ * @returns None
+ */
+void ssd1322_set_transport(const ssd1322_transport_t * transport);
+
 /**
  * @brief   Writes a single byte of data to the SSD1322 chip.
  * @param   data: The data to be written. 
@@ -164,6 +470,43 @@ void ssd1322_write_data_buffer(uint8_t * fb, uint32_t buffer_size);
  */
 void ssd1322_write_command(uint8_t command);
 
+/**
+ * @brief   This function empties a command stream so it can be reused.
+ * @param   stream: A pointer to the command stream.
+ * @returns None
+ */
+void ssd1322_stream_begin(ssd1322_stream_t * stream);
+
+/**
+ * @brief   This function appends a command byte to a command stream.
+ *          The stream is sent if it is full.
+ *
+ * @param   stream: A pointer to the command stream.
+ * @param   command: The command to be appended.
+ * @returns None
+ */
+void ssd1322_stream_command(ssd1322_stream_t * stream, uint8_t command);
+
+/**
+ * @brief   This function appends a parameter (data) byte to a command stream.
+ *          The stream is sent if it is full.
+ *
+ * @param   stream: A pointer to the command stream.
+ * @param   data: The parameter to be appended.
+ * @returns None
+ */
+void ssd1322_stream_data(ssd1322_stream_t * stream, uint8_t data);
+
+/**
+ * @brief   This function sends a command stream to the SSD1322 with a single
+ *          chip select assertion and empties it. The data / command line only
+ *          changes at command / data boundaries and no data is read back.
+ *
+ * @param   stream: A pointer to the command stream.
+ * @returns None
+ */
+void ssd1322_stream_send(ssd1322_stream_t * stream);
+
 /**
  * @brief   This function sets the column address of the SSD1322 GDDRAM.
  *          The column address is set as a range from initial address to final address.
@@ -207,12 +550,149 @@ void ssd1322_set_start_line(uint8_t start_line);
  */
 void ssd1322_set_display_on_off(uint8_t display_on_off);
 
+/**
+ * @brief   This function selects the scan timing of the panel. Scanning
+ *          fewer rows raises the frame rate of the rows kept, partial
+ *          display turns off the rows outside of a range.
+ * @param   profile: The refresh profile, it is copied.
+ * @returns None
+ */
+void ssd1322_set_refresh_profile(const ssd1322_refresh_profile_t *profile);
+
+/**
+ * @brief   This function reports the refresh profile in use.
+ * @param   None
+ * @returns The refresh profile in use.
+ */
+const ssd1322_refresh_profile_t * ssd1322_get_refresh_profile(void);
+
+/**
+ * @brief   This function estimates the frame rate and row time of a
+ *          refresh profile from the nominal oscillator frequency.
+ * @param   profile: The refresh profile, NULL for the one in use.
+ * @param   info: Filled with the estimates.
+ * @returns None
+ */
+void ssd1322_estimate_refresh(const ssd1322_refresh_profile_t *profile,
+                              ssd1322_refresh_info_t *info);
+
+/**
+ * @brief   This function selects the display mode. The GDDRAM is left as
+ *          it is, so a mode change costs a single command byte.
+ * @param   display_mode: One of the DISPLAY_MODE_* options.
+ * @returns None
+ */
+void ssd1322_select_display_mode(uint8_t display_mode);
+
+/**
+ * @brief   This function reports the display mode last selected.
+ * @param   None
+ * @returns One of the DISPLAY_MODE_* options.
+ */
+uint8_t ssd1322_get_display_mode(void);
+
+/**
+ * @brief   This function sets the segment output current (contrast) of the
+ *          display without touching the GDDRAM.
+ * @param   contrast_current: The contrast current (0x00 - 0xFF).
+ * @returns None
+ */
+void ssd1322_set_contrast(uint8_t contrast_current);
+
+/**
+ * @brief   This function reports the contrast current last set.
+ * @param   None
+ * @returns The contrast current.
+ */
+uint8_t ssd1322_get_contrast(void);
+
+/**
+ * @brief   This function sets the scale factor of the segment output
+ *          current (master current) without touching the GDDRAM.
+ * @param   master_current: The master current (0x00 - 0x0F).
+ * @returns None
+ */
+void ssd1322_set_master_brightness(uint8_t master_current);
+
+/**
+ * @brief   This function reports the master current last set.
+ * @param   None
+ * @returns The master current.
+ */
+uint8_t ssd1322_get_master_brightness(void);
+
+/**
+ * @brief   This function uploads a custom gray scale table and enables it.
+ *          Pixels already in the GDDRAM take the new gray levels at once.
+ * @param   table: GRAY_SCALE_TABLE_SIZE pulse widths for gray levels 1 - 15.
+ * @returns None
+ */
+void ssd1322_set_gray_scale_table(const uint8_t *table);
+
+/**
+ * @brief   This function selects the default linear gray scale table of
+ *          the SSD1322.
+ * @param   None
+ * @returns None
+ */
+void ssd1322_select_default_gray_scale_table(void);
+
+/**
+ * @brief   This function copies the gray scale table in use. While the
+ *          default table is selected "ssd1322_gray_table_linear" is copied
+ *          as its closest match.
+ * @param   table: Buffer of GRAY_SCALE_TABLE_SIZE bytes.
+ * @returns 1 if a custom table is in use, 0 if the default table is.
+ */
+uint8_t ssd1322_get_gray_scale_table(uint8_t *table);
+
 /**
  * @brief   This function fills the entire SSD1322 GDDRAM with user data.
  * @param   data - the data used to fill the SSD1322 GDDRAM.
- * @returns None
+ * @returns The number of CPU cycles the fill took.
  */
-void ssd1322_fill_ram(uint8_t data);
+uint32_t ssd1322_fill_ram(uint8_t data);
+
+/**
+ * @brief   This function fills a window of the SSD1322 GDDRAM with a single
+ *          repeated byte. The byte is streamed with a single chip select
+ *          assertion, either by DMA or by a write only loop depending on
+ *          SSD1322_FILL_USE_DMA.
+ *
+ * @pre     "delay_init()" should be called for the duration to be measured.
+ *
+ * @param   column_start: The initial column address (0x00 - 0x77).
+ * @param   column_end: The final column address (0x00 - 0x77).
+ * @param   row_start: The initial row address (0x00 - 0x7F).
+ * @param   row_end: The final row address (0x00 - 0x7F).
+ * @param   data: The data used to fill the window.
+ * @returns The number of CPU cycles the fill took.
+ */
+uint32_t ssd1322_fill_ram_window(uint8_t column_start,
+                                 uint8_t column_end,
+                                 uint8_t row_start,
+                                 uint8_t row_end,
+                                 uint8_t data);
+
+/**
+ * @brief   This function reads back a window of the SSD1322 GDDRAM.
+ *          This is only available on transports which can read, such as
+ *          the parallel interface.
+ *
+ * @param   column_start: The initial column address (0x00 - 0x77).
+ * @param   column_end: The final column address (0x00 - 0x77).
+ * @param   row_start: The initial row address (0x00 - 0x7F).
+ * @param   row_end: The final row address (0x00 - 0x7F).
+ * @param   buffer: Where the data read is stored, it must be able to hold
+ *                  (column_end - column_start + 1) * 2 *
+ *                  (row_end - row_start + 1) bytes.
+ * @returns 1 if the window was read, 0 if the transport cannot read.
+ */
+uint8_t ssd1322_read_ram_window(uint8_t column_start,
+                                uint8_t column_end,
+                                uint8_t row_start,
+                                uint8_t row_end,
+                                uint8_t * buffer);
 
 /**
  * @brief   This function initializes the SSD1322 chip.
@@ -224,7 +704,8 @@ void ssd1322_initialize(void);
 /**
  * @brief   This function selects the address of the SSD1322 GDDRAM.
  *          The function automatically selects final x and y coordinates
- *          to enable writing to the entire display.
+ *          to enable writing to the entire display. The y coordinate is
+ *          relative to the GDDRAM page being displayed.
  *
  * @param   x: The initial x coordinate of the GDDRAM.
  * @param   y: The initial y coordinate of the GDDRAM.
@@ -241,6 +722,35 @@ void ssd1322_set_address(uint8_t x, uint8_t y);
  */
 void ssd1322_set_font(const font_t * font);
 
+/**
+ * @brief   This function returns the font used by all text drawing
+ *          functions.
+ *
+ * @param   None
+ * @returns A pointer to the selected font.
+ */
+const font_t * ssd1322_get_font(void);
+
+/**
+ * @brief   This function selects how resources, characters and bitmaps
+ *          drawn into frame buffers are combined with what is there. Blends
+ *          work on 8 pixels at a time with the Cortex-M4 SIMD instructions.
+ *
+ * @param   blend_mode: One of the BLEND_* modes.
+ * @returns None
+ */
+void ssd1322_set_blend_mode(uint8_t blend_mode);
+
+/**
+ * @brief   This function sets the parameters of the BLEND_ALPHA mode.
+ *
+ * @param   alpha: The opacity of resource pixels, from 0 (invisible)
+ *                 to 15 (opaque).
+ * @param   key: The gray level of resource pixels which are transparent.
+ * @returns None
+ */
+void ssd1322_set_blend_alpha(uint8_t alpha, uint8_t key);
+
 void ssd1322_put_pixel_fb(uint8_t * fb, uint8_t x_virtual, uint8_t y);
 
 /**
@@ -294,20 +804,21 @@ void ssd1322_put_rectangle_fb(uint8_t * fb,
 
 /**
  * @brief   This function draws a resource (character or bitmap) starting from
- *          the user selected coordinates into a frame buffer.
+ *          the user selected coordinates into a frame buffer. The resource
+ *          is clipped to the clip rectangle, so it may start off screen.
  *
  * @param   fb: A pointer to the frame buffer to draw the resource into.
  * @param   x_virtual: The x coordinate to begin drawing the resource.
  * @param   y: The y coordinate to begin drawing the resource.
  * @param   rows: The height of the resource in pixels.
- * @param   columns: The width of the resource in pixels.
+ * @param   columns: The width of the resource in bytes (2 pixels each).
  * @param   resource_ptr: A pointer to the resource to be drawn into the frame buffer.
  *
- * @returns The current x coordinate of the frame buffer.
+ * @returns None
  */
 void ssd1322_put_resource_fb(uint8_t *fb,
-                             uint8_t x_virtual,
-                             uint8_t y,
+                             int16_t x_virtual,
+                             int16_t y,
                              uint8_t rows,
                              uint8_t columns,
                              const uint8_t *resource_ptr);
@@ -323,8 +834,8 @@ void ssd1322_put_resource_fb(uint8_t *fb,
  * @returns None
  */
 void ssd1322_put_bitmap_fb(uint8_t *fb,
-                           uint8_t x_virtual,
-                           uint8_t y,
+                           int16_t x_virtual,
+                           int16_t y,
                            const bitmap_t *bmp);
 
 /**
@@ -336,9 +847,9 @@ void ssd1322_put_bitmap_fb(uint8_t *fb,
  * @param   y: The y coordinate to begin drawing the character.
  * @param   c: The character to be drawn into the frame buffer.
  *
- * @returns The current x coordinate of the frame buffer.
+ * @returns The advance width of the character.
  */
-uint8_t ssd1322_put_char_fb(uint8_t * fb, uint8_t x_virtual, uint8_t y, const char c);
+uint8_t ssd1322_put_char_fb(uint8_t * fb, int16_t x_virtual, int16_t y, const char c);
 
 /**
  * @brief   This function draws a string into a frame buffer starting from
@@ -351,19 +862,405 @@ uint8_t ssd1322_put_char_fb(uint8_t * fb, uint8_t x_virtual, uint8_t y, const ch
  *
  * @returns The current x coordinate of the frame buffer.
  */
-uint8_t ssd1322_put_string_fb(uint8_t * fb,
-                              uint8_t x_virtual,
-                              uint8_t y,
+int16_t ssd1322_put_string_fb(uint8_t * fb,
+                              int16_t x_virtual,
+                              int16_t y,
                               const char * string);
 
+/**
+ * @brief   This function sets the rectangle resources, characters and
+ *          bitmaps drawn into frame buffers are clipped to.
+ *
+ * @param   x_virtual_start: The first pixel column drawn.
+ * @param   y_start: The first pixel row drawn.
+ * @param   x_virtual_end: The last pixel column drawn.
+ * @param   y_end: The last pixel row drawn.
+ * @returns None
+ */
+void ssd1322_set_clip_fb(uint8_t x_virtual_start,
+                         uint8_t y_start,
+                         uint8_t x_virtual_end,
+                         uint8_t y_end);
+
+/**
+ * @brief   This function clips frame buffer drawing to the whole frame
+ *          buffer again.
+ * @param   None
+ * @returns None
+ */
+void ssd1322_reset_clip_fb(void);
+
+/**
+ * @brief   This function sets up a surface over a block of pixels and builds
+ *          its row table. Drawing into it is not recorded as dirty, use
+ *          "ssd1322_surface_init_fb()" for display frame buffers.
+ *
+ * @param   surface: The surface to set up.
+ * @param   pixels: The first byte of the top row.
+ * @param   row_table: Storage for height row pointers.
+ * @param   width: The width in pixels, rounded down to an even number.
+ * @param   height: The number of rows.
+ * @param   stride: The bytes between the start of two rows.
+ * @returns None
+ */
+void ssd1322_surface_init(ssd1322_surface_t * surface,
+                          uint8_t * pixels,
+                          uint8_t ** row_table,
+                          uint16_t width,
+                          uint8_t height,
+                          uint16_t stride);
+
+/**
+ * @brief   This function sets up a surface over a whole display frame
+ *          buffer. Drawing into it, or into views of it, is recorded as
+ *          dirty for "ssd1322_flush_dirty_fb()".
+ *
+ * @param   surface: The surface to set up.
+ * @param   fb: A pointer to the frame buffer.
+ * @param   row_table: Storage for BUFFER_HEIGHT row pointers.
+ * @returns None
+ */
+void ssd1322_surface_init_fb(ssd1322_surface_t * surface,
+                             uint8_t * fb,
+                             uint8_t ** row_table);
+
+/**
+ * @brief   This function sets up a view into part of a surface. The view
+ *          shares the pixels and the row table of its parent, nothing is
+ *          copied. The view is kept inside of its parent and records dirty
+ *          regions if its parent does.
+ *
+ * @param   view: The surface to set up as a view.
+ * @param   parent: The surface viewed into.
+ * @param   x_virtual: The first pixel column, rounded down to an even one.
+ * @param   y: The first row.
+ * @param   width: The width in pixels.
+ * @param   height: The number of rows.
+ * @returns None
+ */
+void ssd1322_surface_view(ssd1322_surface_t * view,
+                          const ssd1322_surface_t * parent,
+                          uint16_t x_virtual,
+                          uint8_t y,
+                          uint16_t width,
+                          uint8_t height);
+
+/**
+ * @brief   This function sets the rectangle drawing into a surface is
+ *          clipped to. The rectangle is kept inside of the surface.
+ *
+ * @param   surface: The surface.
+ * @param   x_virtual_start: The first pixel column drawn.
+ * @param   y_start: The first pixel row drawn.
+ * @param   x_virtual_end: The last pixel column drawn.
+ * @param   y_end: The last pixel row drawn.
+ * @returns None
+ */
+void ssd1322_surface_set_clip(ssd1322_surface_t * surface,
+                              uint16_t x_virtual_start,
+                              uint8_t y_start,
+                              uint16_t x_virtual_end,
+                              uint8_t y_end);
+
+/**
+ * @brief   This function clips drawing to the whole surface again.
+ *
+ * @param   surface: The surface.
+ * @returns None
+ */
+void ssd1322_surface_reset_clip(ssd1322_surface_t * surface);
+
+/**
+ * @brief   This function fills a whole surface with a byte, ignoring its
+ *          clip rectangle. Contiguous rows are filled as one span.
+ *
+ * @param   surface: The surface to fill.
+ * @param   data: The byte (two pixels) to fill with.
+ * @returns The CPU cycles taken.
+ */
+uint32_t ssd1322_surface_fill(ssd1322_surface_t * surface, uint8_t data);
+
+/**
+ * @brief   This function sets a pixel of a surface to gray level 15.
+ *
+ * @param   surface: The surface to draw into.
+ * @param   x_virtual: The pixel column.
+ * @param   y: The pixel row.
+ * @returns None
+ */
+void ssd1322_surface_put_pixel(ssd1322_surface_t * surface, int16_t x_virtual, int16_t y);
+
+/**
+ * @brief   This function draws a horizontal line into a surface. Only
+ *          bytes with both pixels inside of the clip rectangle are drawn.
+ *
+ * @param   surface: The surface to draw into.
+ * @param   x: The byte column to begin drawing the line.
+ * @param   y: The row of the line.
+ * @param   length: The length of the line. 1 length = 2 pixels.
+ * @returns None
+ */
+void ssd1322_surface_put_horizontal_line(ssd1322_surface_t * surface,
+                                         uint16_t x,
+                                         uint8_t y,
+                                         uint16_t length);
+
+/**
+ * @brief   This function draws a vertical line into a surface.
+ *
+ * @param   surface: The surface to draw into.
+ * @param   x: The byte column of the line.
+ * @param   y: The row to begin drawing the line.
+ * @param   height: The height of the line.
+ * @param   align: ALIGN_LEFT or ALIGN_RIGHT, the pixel of the byte drawn.
+ * @returns None
+ */
+void ssd1322_surface_put_vertical_line(ssd1322_surface_t * surface,
+                                       uint16_t x,
+                                       uint8_t y,
+                                       uint8_t height,
+                                       uint8_t align);
+
+/**
+ * @brief   This function draws a rectangle into a surface.
+ *
+ * @param   surface: The surface to draw into.
+ * @param   x_1: The byte column of the top left corner.
+ * @param   y_1: The row of the top left corner.
+ * @param   x_2: The byte column of the bottom right corner.
+ * @param   y_2: The row of the bottom right corner.
+ * @returns None
+ */
+void ssd1322_surface_put_rectangle(ssd1322_surface_t * surface,
+                                   uint16_t x_1,
+                                   uint8_t y_1,
+                                   uint16_t x_2,
+                                   uint8_t y_2);
+
+/**
+ * @brief   This function draws a resource into a surface with the active
+ *          blend mode, clipped to the clip rectangle of the surface.
+ *
+ * @param   surface: The surface to draw into.
+ * @param   x_virtual: The x coordinate to begin drawing the resource.
+ * @param   y: The y coordinate to begin drawing the resource.
+ * @param   rows: The number of rows of the resource.
+ * @param   columns: The number of bytes (2 pixels each) per row.
+ * @param   resource_ptr: A pointer to the resource.
+ * @returns None
+ */
+void ssd1322_surface_put_resource(ssd1322_surface_t * surface,
+                                  int16_t x_virtual,
+                                  int16_t y,
+                                  uint8_t rows,
+                                  uint8_t columns,
+                                  const uint8_t * resource_ptr);
+
+/**
+ * @brief   This function draws one surface into another with the active
+ *          blend mode, e.g. to compose an off-screen surface into a frame
+ *          buffer. The clip rectangle of the source is not applied.
+ *
+ * @param   surface: The surface to draw into.
+ * @param   x_virtual: The x coordinate to begin drawing the source.
+ * @param   y: The y coordinate to begin drawing the source.
+ * @param   source: The surface drawn.
+ * @returns None
+ */
+void ssd1322_surface_put_surface(ssd1322_surface_t * surface,
+                                 int16_t x_virtual,
+                                 int16_t y,
+                                 const ssd1322_surface_t * source);
+
+/**
+ * @brief   This function draws a bitmap into a surface.
+ *
+ * @param   surface: The surface to draw into.
+ * @param   x_virtual: The x coordinate to begin drawing the bitmap.
+ * @param   y: The y coordinate to begin drawing the bitmap.
+ * @param   bmp: A pointer to the bitmap to be drawn.
+ * @returns None
+ */
+void ssd1322_surface_put_bitmap(ssd1322_surface_t * surface,
+                                int16_t x_virtual,
+                                int16_t y,
+                                const bitmap_t * bmp);
+
+/**
+ * @brief   This function draws a character into a surface using the
+ *          active font.
+ *
+ * @param   surface: The surface to draw into.
+ * @param   x_virtual: The x coordinate to begin drawing the character.
+ * @param   y: The y coordinate to begin drawing the character.
+ * @param   c: The character to be drawn.
+ * @returns The advance width of the character.
+ */
+uint8_t ssd1322_surface_put_char(ssd1322_surface_t * surface,
+                                 int16_t x_virtual,
+                                 int16_t y,
+                                 const char c);
+
+/**
+ * @brief   This function draws a string into a surface starting from the
+ *          supplied coordinates.
+ *
+ * @param   surface: The surface to draw into.
+ * @param   x_virtual: The x coordinate to begin drawing the string.
+ * @param   y: The y coordinate to begin drawing the string.
+ * @param   string: The string to be displayed.
+ * @returns The current x coordinate of the surface.
+ */
+int16_t ssd1322_surface_put_string(ssd1322_surface_t * surface,
+                                   int16_t x_virtual,
+                                   int16_t y,
+                                   const char * string);
+
+/**
+ * @brief   This function draws a resource straight into the GDDRAM, without
+ *          a frame buffer. A window covering the resource is opened and the
+ *          resource is streamed into it row by row. The window is widened
+ *          to whole column addresses (4 pixels) and the pixels added are
+ *          set to IMMEDIATE_BACKGROUND.
+ *
+ * @param   x_virtual: The x coordinate to begin drawing the resource.
+ * @param   y: The y coordinate to begin drawing the resource.
+ * @param   rows: The number of rows of the resource.
+ * @param   columns: The number of bytes (2 pixels each) per row.
+ * @param   resource_ptr: A pointer to the resource.
+ * @returns None
+ */
+void ssd1322_put_resource(uint8_t x_virtual,
+                          uint8_t y,
+                          uint8_t rows,
+                          uint8_t columns,
+                          const uint8_t * resource_ptr);
+
+/**
+ * @brief   Displays a bitmap straight into the GDDRAM, without a frame
+ *          buffer.
+ *
+ * @param   x_virtual: The x coordinate to begin drawing the bitmap.
+ * @param   y: The y coordinate to begin drawing the bitmap.
+ * @param   bmp: A pointer to the bitmap to be drawn.
+ * @returns None
+ */
+void ssd1322_put_bitmap(uint8_t x_virtual, uint8_t y, const bitmap_t * bmp);
+
+/**
+ * @brief   This function draws a character straight into the GDDRAM,
+ *          without a frame buffer, using the active font.
+ *
+ * @param   x_virtual: The x coordinate to begin drawing the character.
+ * @param   y: The y coordinate to begin drawing the character.
+ * @param   c: The character to be drawn.
+ * @returns The advance width of the character.
+ */
+uint8_t ssd1322_put_char(uint8_t x_virtual, uint8_t y, const char c);
+
+/**
+ * @brief   This function draws a string straight into the GDDRAM, without
+ *          a frame buffer, using the active font.
+ *
+ * @param   x_virtual: The x coordinate to begin drawing the string.
+ * @param   y: The y coordinate to begin drawing the string.
+ * @param   string: The string to be drawn.
+ * @returns The x coordinate following the string.
+ */
+uint8_t ssd1322_put_string(uint8_t x_virtual, uint8_t y, const char * string);
+
+/**
+ * @brief   This function draws a rectangle straight into the GDDRAM, without
+ *          a frame buffer. The coordinates are the same as for
+ *          "ssd1322_put_rectangle_fb()", the other byte of the column
+ *          addresses holding the vertical edges is set to
+ *          IMMEDIATE_BACKGROUND.
+ *
+ * @param   x_1: The x coordinate (byte) of the upper left corner.
+ * @param   y_1: The y coordinate of the upper left corner.
+ * @param   x_2: The x coordinate (byte) of the bottom right corner.
+ * @param   y_2: The y coordinate of the bottom right corner.
+ * @returns None
+ */
+void ssd1322_put_rectangle(uint8_t x_1, uint8_t y_1, uint8_t x_2, uint8_t y_2);
+
+/**
+ * @brief   This function records a region of the frame buffer as changed,
+ *          so it is sent by the next "ssd1322_flush_dirty_fb()". Drawing
+ *          functions do this themselves, it is only needed after writing
+ *          into the frame buffer directly. The region is widened to whole
+ *          column addresses (4 pixels) and clipped to the frame buffer.
+ *
+ * @param   x_virtual_start: The first pixel column.
+ * @param   y_start: The first pixel row.
+ * @param   x_virtual_end: The last pixel column.
+ * @param   y_end: The last pixel row.
+ * @returns None
+ */
+void ssd1322_mark_dirty_fb(uint8_t x_virtual_start,
+                           uint8_t y_start,
+                           uint8_t x_virtual_end,
+                           uint8_t y_end);
+
+/**
+ * @brief   This function sends the regions of a frame buffer changed since
+ *          the last flush to the ssd1322 GDDRAM and clears them. Each dirty
+ *          rectangle is sent through its own column / row address window.
+ *
+ * @note    Dirty regions are tracked for the frame buffer being drawn, not
+ *          per buffer. Double buffered rendering should keep using
+ *          "ssd1322_fb_pair_swap()", which always sends whole frames.
+ *
+ * @param   fb: A pointer to the frame buffer whose changes are displayed.
+ * @returns The number of frame buffer bytes sent.
+ */
+uint32_t ssd1322_flush_dirty_fb(uint8_t * fb);
+
+/**
+ * @brief   This function sends the parts of a frame buffer whose content
+ *          changed since the last content-diff flush. Each row is hashed
+ *          in SSD1322_DIFF_SEGMENT_BYTES segments by the CRC unit and
+ *          compared against the hashes of the last flush, so direct writes
+ *          into the frame buffer are seen as well. Changed rows are merged
+ *          into one window whenever resending the bytes in between costs
+ *          less than SSD1322_WINDOW_COST_BYTES.
+ *
+ * @note    The frame buffer should be word aligned. The first flush, and the
+ *          first flush after anything else wrote into GDDRAM, sends
+ *          everything.
+ *
+ * @param   fb: A pointer to the frame buffer whose changes are displayed.
+ * @returns The number of frame buffer bytes sent.
+ */
+uint32_t ssd1322_flush_diff_fb(uint8_t * fb);
+
+/**
+ * @brief   This function makes the next content-diff flush send the whole
+ *          frame buffer. Every WRITE_RAM command sent through the driver
+ *          does this already, call it after changing the GDDRAM around the
+ *          driver.
+ *
+ * @param   None
+ * @returns None
+ */
+void ssd1322_invalidate_diff_fb(void);
+
+/**
+ * @brief   This function reads the statistics of the last content-diff flush.
+ *
+ * @param   stats: Where the statistics are stored.
+ * @returns None
+ */
+void ssd1322_get_diff_stats(ssd1322_diff_stats_t * stats);
+
 /**
  * @brief   This function fills a frame buffer with the provided data.
  *
  * @param   fb: A pointer to the frame buffer to fill.
  * @param   data: The data to fill the frame buffer with.
- * @returns None
+ * @returns The number of CPU cycles the fill took.
  */
-void ssd1322_fill_fb(uint8_t * fb, uint8_t data);
+uint32_t ssd1322_fill_fb(uint8_t * fb, uint8_t data);
 
 /**
  * @brief   This function dumps the contents of a frame buffer to a section of
@@ -374,4 +1271,164 @@ void ssd1322_fill_fb(uint8_t * fb, uint8_t data);
  */
 void ssd1322_display_fb(uint8_t * fb);
 
+/**
+ * @brief   This function starts dumping the contents of a frame buffer to the
+ *          ssd1322 GDDRAM using DMA and returns immediately.
+ *
+ * @note    The frame buffer must not be placed in CCM RAM as the DMA has no
+ *          access to it, and it must not be modified until the transfer
+ *          completes. The buffer is only read, it is sent as is. With
+ *          page flipping enabled the uploaded page is shown from thread
+ *          context by the next driver call, such as
+ *          "ssd1322_display_fb_busy()" returning 0 or
+ *          "ssd1322_fb_pair_swap()", never by the interrupt handler.
+ *
+ * @param   fb: A pointer to the frame buffer whose contents is to be displayed.
+ * @param   callback: Function called from interrupt context when the transfer
+ *                    completes, may be NULL.
+ * @returns None
+ */
+void ssd1322_display_fb_async(uint8_t * fb, ssd1322_callback_t callback);
+
+/**
+ * @brief   This function checks if an asynchronous frame buffer transfer
+ *          is still in progress. Once it has completed, a pending page flip
+ *          is sent.
+ *
+ * @param   None
+ * @returns 1 if a transfer is in progress, 0 otherwise.
+ */
+uint8_t ssd1322_display_fb_busy(void);
+
+/**
+ * @brief   This function enables tear-free page flipping. The panel shows 64
+ *          of the 128 GDDRAM rows, so whole frames sent by
+ *          "ssd1322_display_fb()" and "ssd1322_display_fb_async()" are
+ *          uploaded into the hidden half (rows 0 - 63 or 64 - 127) and
+ *          shown with a single SET_DISPLAY_START_LINE command once
+ *          complete. The halves alternate every frame, no second frame
+ *          buffer is needed in MCU RAM.
+ *
+ * @note    Partial flushes and "ssd1322_set_address()" write into the page
+ *          being displayed.
+ *
+ * @param   enable: 1 to enable page flipping, 0 to write frames into the
+ *                  page being displayed.
+ * @returns None
+ */
+void ssd1322_set_page_flip(uint8_t enable);
+
+/**
+ * @brief   This function starts scrolling a frame buffer. The frame buffer is
+ *          uploaded once and the GDDRAM row it starts at is displayed.
+ *
+ * @note    Page flipping and partial flushes must not be used while
+ *          scrolling, scrolling uses all 128 GDDRAM rows.
+ *
+ * @param   scroll: The scroll state to set up.
+ * @param   fb: The frame buffer, it is used as a ring of rows from now on.
+ * @returns None
+ */
+void ssd1322_scroll_init(ssd1322_scroll_t * scroll, uint8_t * fb);
+
+/**
+ * @brief   This function scrolls the display up by one row per row given.
+ *          Each row is uploaded into the GDDRAM row below the bottom of the
+ *          display, then the start line moves down so it becomes visible.
+ *          Only BUFFER_WIDTH bytes and the window / start line commands
+ *          are sent per row.
+ *
+ * @param   scroll: The scroll state.
+ * @param   rows: The rows entering at the bottom, BUFFER_WIDTH bytes each.
+ * @param   count: The number of rows.
+ * @returns None
+ */
+void ssd1322_scroll_up(ssd1322_scroll_t * scroll,
+                       const uint8_t * rows,
+                       uint8_t count);
+
+/**
+ * @brief   This function scrolls the display down by one row per row given.
+ *          Each row is uploaded into the GDDRAM row above the top of the
+ *          display, then the start line moves up so it becomes visible.
+ *
+ * @param   scroll: The scroll state.
+ * @param   rows: The rows entering at the top, BUFFER_WIDTH bytes each. The
+ *                first row given ends up at the top.
+ * @param   count: The number of rows.
+ * @returns None
+ */
+void ssd1322_scroll_down(ssd1322_scroll_t * scroll,
+                         const uint8_t * rows,
+                         uint8_t count);
+
+/**
+ * @brief   This function maps a displayed row onto the frame buffer ring.
+ *
+ * @param   scroll: The scroll state.
+ * @param   y: The displayed row (0 - 63).
+ * @returns A pointer to the frame buffer row shown at row y.
+ */
+uint8_t * ssd1322_scroll_row(const ssd1322_scroll_t * scroll, uint8_t y);
+
+/**
+ * @brief   This function selects the orientation of the display through the
+ *          re-map register, so frame buffers are sent as they are whichever
+ *          way the panel is mounted. The column offset of the display is
+ *          adjusted for mirrored columns.
+ *
+ * @note    The display is mirrored in place. Content written before the
+ *          change should be sent again if the column offset changed.
+ *
+ * @param   orientation: A combination of the ORIENTATION_* options.
+ * @returns None
+ */
+void ssd1322_set_orientation(uint8_t orientation);
+
+/**
+ * @brief   This function reports the GDDRAM column address of the left edge
+ *          of the display. It is DISPLAY_COLUMN_START in every orientation,
+ *          callers writing their own windows use it so they do not depend
+ *          on that.
+ *
+ * @param   None
+ * @returns The column address.
+ */
+uint8_t ssd1322_get_column_offset(void);
+
+/**
+ * @brief   This function reports which GDDRAM page is being displayed.
+ *          It waits for any asynchronous transfer, so a pending page flip
+ *          is included.
+ *
+ * @param   None
+ * @returns The first GDDRAM row of the page (0 or 64).
+ */
+uint8_t ssd1322_get_page_row(void);
+
+/**
+ * @brief   This function sets up a pair of frame buffers for double buffered
+ *          rendering. The application owns the back buffer (fb_0) first.
+ *
+ * @param   pair: A pointer to the frame buffer pair to set up.
+ * @param   fb_0: A pointer to the first frame buffer.
+ * @param   fb_1: A pointer to the second frame buffer.
+ * @returns None
+ */
+void ssd1322_fb_pair_init(ssd1322_fb_pair_t * pair, uint8_t * fb_0, uint8_t * fb_1);
+
+/**
+ * @brief   This function hands the back buffer over to the display and starts
+ *          transferring it, then hands the previous front buffer back to the
+ *          application. It waits for the previous front buffer transfer to
+ *          complete so the returned buffer is never in flight.
+ *
+ * @note    The application must not write into a buffer after passing it to
+ *          this function, only into the buffer that is returned.
+ *
+ * @param   pair: A pointer to the frame buffer pair.
+ * @returns A pointer to the new back buffer.
+ */
+uint8_t * ssd1322_fb_pair_swap(ssd1322_fb_pair_t * pair);
+
 #endif /* INC_SSD1322_H_ */
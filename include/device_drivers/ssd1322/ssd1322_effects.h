@@ -0,0 +1,247 @@
+/**
+ * @file   ssd1322_effects.h
+ * @author Adom Kwabena
+ * @brief  This module animates the SSD1322 through its control registers,
+ *         so effects cost a few command bytes per step instead of a frame.
+ *
+ *         Palette animations rewrite single entries of the gray scale
+ *         table, so pixels drawn with a reserved gray level blink or pulse
+ *         without any pixel traffic.
+ *
+ *         Flashes switch between display modes (e.g. inverse or all on)
+ *         on a schedule, a full screen alert costs one command byte per
+ *         toggle instead of a frame upload.
+ *
+ *         Effects are advanced by "ssd1322_effects_update()", which should
+ *         be called regularly (e.g. every frame or from a timer tick) with
+ *         a millisecond time base.
+ */
+
+// Prevent multiple file inclusion
+#ifndef __SSD1322_EFFECTS_INC__
+#define __SSD1322_EFFECTS_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+#include "ssd1322.h"
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// Easing curves
+// LINEAR - constant speed
+// IN - starts slowly (quadratic)
+// OUT - ends slowly (quadratic)
+// IN_OUT - starts and ends slowly (smoothstep)
+#define EASE_LINEAR                             0U
+#define EASE_IN                                 1U
+#define EASE_OUT                                2U
+#define EASE_IN_OUT                             3U
+
+// Repeat an effect until it is cancelled
+#define EFFECT_FOREVER                          0U
+
+// Palette animation modes
+// BLINK - the first half of a period at the high pulse width, then low
+// PULSE - eased from low to high and back every period
+#define PALETTE_BLINK                           0U
+#define PALETTE_PULSE                           1U
+
+// Longest flash pattern, in steps
+#define FLASH_PATTERN_MAX                       32U
+
+// Number of gray levels which can be animated at the same time
+#ifndef SSD1322_PALETTE_CHANNELS
+#define SSD1322_PALETTE_CHANNELS                4U
+#endif
+
+// ****************************************************************************
+// * Module Data Structures
+// ****************************************************************************
+
+// Function called when an effect ends.
+// completed: 1 if the effect ran to its end, 0 if it was cancelled.
+typedef void (*ssd1322_effect_callback_t)(uint8_t completed);
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+/**
+ * @brief   This function advances all running effects. Commands are only
+ *          sent when a register value changes.
+ *
+ * @param   now_ms: The current time in milliseconds, it may wrap around.
+ * @returns None
+ */
+void ssd1322_effects_update(uint32_t now_ms);
+
+/**
+ * @brief   This function fades the brightness from the current contrast and
+ *          master current to new values. Any running fade is cancelled.
+ *
+ * @param   contrast_current: The final contrast current (0x00 - 0xFF).
+ * @param   master_current: The final master current (0x00 - 0x0F).
+ * @param   duration_ms: The duration of the fade.
+ * @param   easing: The easing curve (EASE_*).
+ * @param   now_ms: The current time in milliseconds.
+ * @param   callback: Function called when the fade ends, may be NULL.
+ * @returns None
+ */
+void ssd1322_fade_to(uint8_t contrast_current,
+                     uint8_t master_current,
+                     uint32_t duration_ms,
+                     uint8_t easing,
+                     uint32_t now_ms,
+                     ssd1322_effect_callback_t callback);
+
+/**
+ * @brief   This function pulses the contrast current between its current
+ *          value and another one, one pulse goes there and back. Any
+ *          running fade is cancelled.
+ *
+ * @param   contrast_current: The contrast current at the peak of a pulse.
+ * @param   period_ms: The duration of one pulse.
+ * @param   count: The number of pulses, or EFFECT_FOREVER.
+ * @param   easing: The easing curve of each half pulse (EASE_*).
+ * @param   now_ms: The current time in milliseconds.
+ * @param   callback: Function called when the pulses end, may be NULL.
+ * @returns None
+ */
+void ssd1322_pulse(uint8_t contrast_current,
+                   uint32_t period_ms,
+                   uint16_t count,
+                   uint8_t easing,
+                   uint32_t now_ms,
+                   ssd1322_effect_callback_t callback);
+
+/**
+ * @brief   This function cancels a running fade or pulse. The brightness is
+ *          left where it is, or set back to the start of the effect.
+ *
+ * @param   restore: 1 to go back to the brightness before the effect.
+ * @returns None
+ */
+void ssd1322_fade_cancel(uint8_t restore);
+
+/**
+ * @brief   This function checks if a fade or pulse is running.
+ *
+ * @param   None
+ * @returns 1 if an effect is running, 0 otherwise.
+ */
+uint8_t ssd1322_fade_busy(void);
+
+/**
+ * @brief   This function animates the pulse width of a gray level. Pixels
+ *          drawn with the level follow it, so the level should be reserved
+ *          for the animated content. The gray scale table in use when the
+ *          first level is animated is restored once the last one stops.
+ *
+ *          The datasheet specifies ascending table entries, keep the pulse
+ *          widths between those of the neighbouring levels where that
+ *          matters.
+ *
+ * @param   gray_level: The gray level to animate (1 - 15).
+ * @param   low: The lowest pulse width (0 - GRAY_SCALE_MAX).
+ * @param   high: The highest pulse width (0 - GRAY_SCALE_MAX).
+ * @param   period_ms: The duration of one blink or pulse.
+ * @param   mode: PALETTE_BLINK or PALETTE_PULSE.
+ * @param   easing: The easing curve of each half pulse (EASE_*).
+ * @param   now_ms: The current time in milliseconds.
+ * @returns 1 if the animation started, 0 if the level is invalid or all
+ *          SSD1322_PALETTE_CHANNELS are in use.
+ */
+uint8_t ssd1322_palette_animate(uint8_t gray_level,
+                                uint8_t low,
+                                uint8_t high,
+                                uint32_t period_ms,
+                                uint8_t mode,
+                                uint8_t easing,
+                                uint32_t now_ms);
+
+/**
+ * @brief   This function stops the animation of a gray level and gives it
+ *          back its pulse width.
+ *
+ * @param   gray_level: The animated gray level.
+ * @returns None
+ */
+void ssd1322_palette_stop(uint8_t gray_level);
+
+/**
+ * @brief   This function stops all palette animations and restores the
+ *          gray scale table.
+ *
+ * @param   None
+ * @returns None
+ */
+void ssd1322_palette_stop_all(void);
+
+/**
+ * @brief   This function flashes the display, switching between a display
+ *          mode and the mode in use. The mode in use is restored once the
+ *          flashes end. Any running flash is cancelled.
+ *
+ * @param   display_mode: The mode flashed in (DISPLAY_MODE_*).
+ * @param   on_ms: The time spent in the flashed mode.
+ * @param   off_ms: The time spent in the mode in use.
+ * @param   count: The number of flashes, or EFFECT_FOREVER.
+ * @param   now_ms: The current time in milliseconds.
+ * @param   callback: Function called when the flashes end, may be NULL.
+ * @returns None
+ */
+void ssd1322_flash(uint8_t display_mode,
+                   uint32_t on_ms,
+                   uint32_t off_ms,
+                   uint16_t count,
+                   uint32_t now_ms,
+                   ssd1322_effect_callback_t callback);
+
+/**
+ * @brief   This function flashes the display with a blink pattern. Each
+ *          step of the pattern lasts step_ms, a set bit selects the flashed
+ *          mode and a clear bit the mode in use, starting from bit 0.
+ *          e.g. pattern 0x15 with length 8 gives three short blinks and a
+ *          pause. The mode in use is restored once the pattern has been
+ *          repeated count times. Any running flash is cancelled.
+ *
+ * @param   display_mode: The mode flashed in (DISPLAY_MODE_*).
+ * @param   pattern: The blink pattern.
+ * @param   length: The number of steps in the pattern (1 - FLASH_PATTERN_MAX).
+ * @param   step_ms: The duration of one step.
+ * @param   count: The number of repetitions, or EFFECT_FOREVER.
+ * @param   now_ms: The current time in milliseconds.
+ * @param   callback: Function called when the flashes end, may be NULL.
+ * @returns None
+ */
+void ssd1322_flash_pattern(uint8_t display_mode,
+                           uint32_t pattern,
+                           uint8_t length,
+                           uint32_t step_ms,
+                           uint16_t count,
+                           uint32_t now_ms,
+                           ssd1322_effect_callback_t callback);
+
+/**
+ * @brief   This function cancels a running flash and restores the display
+ *          mode in use before it.
+ *
+ * @param   None
+ * @returns None
+ */
+void ssd1322_flash_cancel(void);
+
+/**
+ * @brief   This function checks if a flash is running.
+ *
+ * @param   None
+ * @returns 1 if a flash is running, 0 otherwise.
+ */
+uint8_t ssd1322_flash_busy(void);
+
+#endif /* __SSD1322_EFFECTS_INC__ */
@@ -0,0 +1,104 @@
+/**
+ * @file   ssd1322_marquee.h
+ * @author Adom Kwabena
+ * @brief  This module scrolls a line of text horizontally across a band of
+ *         the display (ticker / marquee).
+ *
+ *         The SSD1322 always maps the same GDDRAM columns to the panel, it
+ *         has no register which moves the displayed columns. The text is
+ *         pre-rendered into an off-screen ring of columns in MCU RAM ahead
+ *         of the visible part instead, and every shift only uploads the
+ *         rows of the band through a windowed write.
+ */
+
+// Prevent multiple file inclusion
+#ifndef __SSD1322_MARQUEE_INC__
+#define __SSD1322_MARQUEE_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+#include "ssd1322.h"
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// Number of blank pixels between the end of the text and its next pass
+#define MARQUEE_GAP                             32U
+// Number of glyphs in a font table (characters 32 - 127)
+#define MARQUEE_GLYPHS                          96U
+
+// ****************************************************************************
+// * Module Data Structures
+// ****************************************************************************
+
+typedef struct
+{
+    // Ring of pre-rendered columns, "height" rows of "width / 2" bytes
+    uint8_t * strip;
+    // Width of the ring in pixels
+    uint16_t width;
+    // Rows of the band
+    uint8_t height;
+    // Display row of the top of the band
+    uint8_t y;
+    // Ring pixel shown at the left edge of the display
+    uint32_t position;
+    // Ring pixel the next glyph is rendered at, counts up like position
+    uint32_t rendered;
+    // Text being scrolled and the next character to render
+    const char * text;
+    const char * next;
+} ssd1322_marquee_t;
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+/**
+ * @brief   This function sets up a marquee.
+ *
+ * @note    The active font is measured, select the font first and do not
+ *          switch to a font with wider glyphs while the marquee runs.
+ *
+ * @param   marquee: The marquee to set up.
+ * @param   strip: The ring of columns, it must hold height * width / 2 bytes.
+ * @param   width: The width of the ring in pixels, an even number of at least
+ *                 DISPLAY_WIDTH + max(widest glyph advance, MARQUEE_GAP).
+ * @param   height: The number of rows of the band, at least 1.
+ * @param   y: The display row of the top of the band.
+ * @returns 1 if the marquee was set up, 0 if the ring is too narrow or the
+ *          band is empty. A marquee which was not set up is never drawn.
+ */
+uint8_t ssd1322_marquee_init(ssd1322_marquee_t * marquee,
+                             uint8_t * strip,
+                             uint16_t width,
+                             uint8_t height,
+                             uint8_t y);
+
+/**
+ * @brief   This function selects the text scrolled by a marquee, the text
+ *          enters from the right edge and repeats after MARQUEE_GAP pixels.
+ *          The active font is used.
+ *
+ * @param   marquee: The marquee.
+ * @param   text: The text, it must remain valid while it is scrolled.
+ * @returns None
+ */
+void ssd1322_marquee_set_text(ssd1322_marquee_t * marquee, const char * text);
+
+/**
+ * @brief   This function shifts a marquee to the left and displays it.
+ *          Glyphs about to enter are rendered into the ring first, then the
+ *          rows of the band are uploaded (height * BUFFER_WIDTH bytes).
+ *
+ * @param   marquee: The marquee.
+ * @param   pixels: The number of pixels to shift by.
+ * @returns None
+ */
+void ssd1322_marquee_step(ssd1322_marquee_t * marquee, uint8_t pixels);
+
+#endif /* __SSD1322_MARQUEE_INC__ */
@@ -0,0 +1,140 @@
+/**
+ * @file   ssd1322_pacing.h
+ * @author Adom Kwabena
+ * @brief  This module paces frame flushes to the scan of the SSD1322.
+ *
+ *         TIM2 ticks once per panel frame, with the period estimated from
+ *         the refresh profile in use (display clock, phase lengths and
+ *         multiplex ratio). Each tick may release a frame, with ticks
+ *         dropped evenly to meet a target frame rate below the panel's.
+ *         Rendering only once a frame is released keeps frame timing
+ *         stable and avoids rendering frames the panel never shows.
+ *
+ *         The panel oscillator is not measured, so the ticks drift
+ *         slowly against the real scan. Calibrate the oscillator figures
+ *         of "ssd1322_estimate_refresh()", or call "ssd1322_pacing_sync()"
+ *         from a frame synchronization edge if one is wired.
+ */
+
+// Prevent multiple file inclusion
+#ifndef __SSD1322_PACING_INC__
+#define __SSD1322_PACING_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+#include "ssd1322.h"
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// Release a frame on every panel frame
+#define PACING_PANEL_RATE                       0U
+
+// ****************************************************************************
+// * Module Data Structures
+// ****************************************************************************
+
+// Pacing statistics
+typedef struct
+{
+    // Panel frames ticked
+    uint32_t ticks;
+    // Frames released
+    uint32_t released;
+    // Released frames the application did not take before the next one
+    uint32_t missed;
+} ssd1322_pacing_stats_t;
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+/**
+ * @brief   This function starts pacing frames to the panel.
+ *
+ * @param   target_centihz: The target frame rate in hundredths of a frame
+ *                          per second, or PACING_PANEL_RATE. Targets above
+ *                          the panel frame rate are limited to it.
+ * @returns None
+ */
+void ssd1322_pacing_start(uint32_t target_centihz);
+
+/**
+ * @brief   This function stops pacing frames.
+ *
+ * @param   None
+ * @returns None
+ */
+void ssd1322_pacing_stop(void);
+
+/**
+ * @brief   This function changes the target frame rate.
+ *
+ * @param   target_centihz: The target frame rate in hundredths of a frame
+ *                          per second, or PACING_PANEL_RATE.
+ * @returns None
+ */
+void ssd1322_pacing_set_target(uint32_t target_centihz);
+
+/**
+ * @brief   This function estimates the panel frame period again, it should
+ *          be called after the refresh profile changes.
+ *
+ * @param   None
+ * @returns None
+ */
+void ssd1322_pacing_refresh(void);
+
+/**
+ * @brief   This function moves the phase of the ticks to this moment.
+ *
+ * @param   None
+ * @returns None
+ */
+void ssd1322_pacing_sync(void);
+
+/**
+ * @brief   This function takes a released frame, if there is one.
+ *
+ * @param   None
+ * @returns 1 if a frame was released since the last call, 0 otherwise.
+ */
+uint8_t ssd1322_pacing_ready(void);
+
+/**
+ * @brief   This function sleeps until a frame is released and takes it.
+ *
+ * @param   None
+ * @returns None
+ */
+void ssd1322_pacing_wait(void);
+
+/**
+ * @brief   This function reports the panel frame period in use.
+ *
+ * @param   None
+ * @returns The panel frame period in nanoseconds.
+ */
+uint32_t ssd1322_pacing_get_period(void);
+
+/**
+ * @brief   This function copies the pacing statistics.
+ *
+ * @param   stats: Filled with the statistics.
+ * @returns None
+ */
+void ssd1322_pacing_get_stats(ssd1322_pacing_stats_t *stats);
+
+/**
+ * @brief   This function clears the pacing statistics.
+ *
+ * @param   None
+ * @returns None
+ */
+void ssd1322_pacing_reset_stats(void);
+
+#endif /* __SSD1322_PACING_INC__ */
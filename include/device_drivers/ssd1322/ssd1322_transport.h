@@ -0,0 +1,107 @@
+/**
+ * @file   ssd1322_transport.h
+ * @author Adom Kwabena
+ * @brief  This module defines the bus interface used by the ssd1322 driver
+ *         along with the available implementations.
+ */
+
+// Prevent multiple file inclusion
+#ifndef __SSD1322_TRANSPORT_INC__
+#define __SSD1322_TRANSPORT_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+#include "ssd1322.h"
+
+// ****************************************************************************
+// * Module Data Structures
+// ****************************************************************************
+
+// Bus interface used by the ssd1322 driver.
+// Bytes are only sent between select() and deselect(). Implementations only
+// change the data / command line when switching between command and data.
+struct ssd1322_transport
+{
+    // Initializes the bus, select and reset lines
+    void (*init)(void);
+    // Drives the reset line of the SSD1322 (0 - reset asserted)
+    void (*set_reset)(uint8_t level);
+    // Asserts chip select
+    void (*select)(void);
+    // Waits for pending bytes to be sent and releases chip select
+    void (*deselect)(void);
+    // Sends command bytes
+    void (*send_command)(const uint8_t * bytes, uint32_t length);
+    // Sends data bytes
+    void (*send_data)(const uint8_t * bytes, uint32_t length);
+    // Sends the same data byte "count" times
+    void (*send_data_repeat)(uint8_t data, uint32_t count);
+    // Starts sending data bytes and returns, the callback is invoked once
+    // the last byte has been sent. Chip select is left asserted.
+    void (*send_data_async)(const uint8_t * bytes, uint32_t length,
+                            ssd1322_callback_t callback);
+    // Waits for all pending bytes to be sent
+    void (*wait_idle)(void);
+    // Reads data bytes, NULL if the bus cannot read from the SSD1322
+    void (*read_data)(uint8_t * bytes, uint32_t length);
+};
+
+// Statistics and GDDRAM image collected by the host memory sink
+typedef struct
+{
+    uint32_t command_bytes;
+    uint32_t data_bytes;
+    uint32_t selects;
+    uint32_t data_command_toggles;
+    uint32_t resets;
+    uint8_t  start_line;
+    uint8_t  remap_format;
+    uint8_t  gddram[GDDRAM_HEIGHT][GDDRAM_WIDTH];
+} ssd1322_host_sink_t;
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Polled SPI1 - every transfer blocks
+extern const ssd1322_transport_t ssd1322_transport_spi1;
+
+// SPI1 with DMA for asynchronous transfers and fills
+extern const ssd1322_transport_t ssd1322_transport_spi1_dma;
+
+// SPI1 fed by a TXE interrupt driven queue, for boards without a free DMA
+// stream. Commands, small data phases, fills and chip select releases are
+// queued and return immediately.
+extern const ssd1322_transport_t ssd1322_transport_spi1_irq;
+
+// 8-bit 8080 parallel bus driven by the FSMC, supports reading GDDRAM
+extern const ssd1322_transport_t ssd1322_transport_fsmc;
+
+// Memory sink emulating the GDDRAM, used to test and benchmark the
+// driver on a host
+extern const ssd1322_transport_t ssd1322_transport_host;
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+/**
+ * @brief   This function clears the statistics and GDDRAM image collected by
+ *          the host memory sink.
+ * @param   None
+ * @returns None
+ */
+void ssd1322_host_sink_reset(void);
+
+/**
+ * @brief   This function provides access to the statistics and GDDRAM image
+ *          collected by the host memory sink.
+ * @param   None
+ * @returns A pointer to the host memory sink.
+ */
+const ssd1322_host_sink_t * ssd1322_host_sink(void);
+
+#endif /* __SSD1322_TRANSPORT_INC__ */
@@ -0,0 +1,59 @@
+/**
+ *  @file   crc.c
+ *  @author Adom Kwabena
+ *  @brief  A driver for the CRC calculation unit of the stm32f407vgt6
+ *          microcontroller.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include "crc.h"
+#include "stm32f407xx.h"
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+void crc_init(void)
+{
+    // Enable CRC clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+
+    crc_reset();
+}
+
+void crc_reset(void)
+{
+    CRC->CR = CRC_CR_RESET;
+}
+
+uint32_t crc_accumulate(const uint32_t * words, uint32_t count)
+{
+    // The bus stalls writes until the previous word is processed,
+    // so words can be written back to back
+    while (count >= 4)
+    {
+        CRC->DR = words[0];
+        CRC->DR = words[1];
+        CRC->DR = words[2];
+        CRC->DR = words[3];
+        words += 4;
+        count -= 4;
+    }
+
+    while (count--)
+    {
+        CRC->DR = *words++;
+    }
+
+    return CRC->DR;
+}
+
+uint32_t crc_compute(const uint32_t * words, uint32_t count)
+{
+    crc_reset();
+
+    return crc_accumulate(words, count);
+}
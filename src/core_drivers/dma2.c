@@ -0,0 +1,81 @@
+/**
+ *  @file   dma2.c
+ *  @author Adom Kwabena
+ *  @brief  A driver for memory to memory transfers on the DMA2 controller
+ *          of the stm32f407vgt6 microcontroller.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include "dma2.h"
+#include "stm32f407xx.h"
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Source of fills, it has to stay valid while the DMA reads it
+static volatile uint32_t g_fill_pattern = 0;
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+void dma2_init(void)
+{
+    // Enable DMA2 clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+
+    // Disable the stream and wait for it to stop before configuring it
+    DMA2_M2M_STREAM->CR &= ~DMA_SxCR_EN;
+    while (DMA2_M2M_STREAM->CR & DMA_SxCR_EN);
+
+    // Memory to memory transfers - the "peripheral" port is the source
+    // (the pattern, not incremented) and the "memory" port the destination.
+    // Use word sized transfers on both sides
+    DMA2_M2M_STREAM->CR = DMA_SxCR_DIR_1 | DMA_SxCR_MINC |
+                          DMA_SxCR_PSIZE_1 | DMA_SxCR_MSIZE_1 | DMA_SxCR_PL_0;
+
+    // Memory to memory transfers require the FIFO, use a full threshold
+    DMA2_M2M_STREAM->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH;
+
+    DMA2_M2M_STREAM->PAR = (uint32_t) &g_fill_pattern;
+
+    // Clear any stale interrupt flags
+    DMA2_M2M_IFCR = DMA2_M2M_CLEAR_FLAGS;
+}
+
+void dma2_fill_words(uint32_t * words, uint32_t pattern, uint32_t count)
+{
+    // Wait for previous fill to complete
+    dma2_wait();
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    g_fill_pattern = pattern;
+
+    // Clear interrupt flags of the previous transfer
+    DMA2_M2M_IFCR = DMA2_M2M_CLEAR_FLAGS;
+
+    DMA2_M2M_STREAM->M0AR = (uint32_t) words;
+    DMA2_M2M_STREAM->NDTR = count;
+
+    // Start transfer
+    DMA2_M2M_STREAM->CR |= DMA_SxCR_EN;
+}
+
+uint8_t dma2_busy(void)
+{
+    return (DMA2_M2M_STREAM->CR & DMA_SxCR_EN) ? 1 : 0;
+}
+
+void dma2_wait(void)
+{
+    // The stream disables itself once the transfer completes
+    while (DMA2_M2M_STREAM->CR & DMA_SxCR_EN);
+}
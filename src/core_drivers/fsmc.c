@@ -0,0 +1,247 @@
+/**
+ *  @file   fsmc.c
+ *  @author Adom Kwabena
+ *  @brief  A driver for the FSMC module of the stm32f407vgt6 microcontroller.
+ * 
+ *          This driver drives an 8-bit 8080 style parallel display bus as
+ *          memory mapped writes to FSMC bank 1 (NOR/SRAM 1). Address line
+ *          A16 selects between the command (A16 = 0) and data (A16 = 1)
+ *          registers of the display.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stddef.h>
+#include "fsmc.h"
+#include "stm32f407xx.h"
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Set while a DMA transfer is in progress
+static volatile uint8_t g_dma_busy = 0;
+// Function to call once the current DMA transfer completes
+static volatile fsmc_callback_t g_dma_callback = NULL;
+
+// ****************************************************************************
+// * Function Prototypes of Private Functions
+// ****************************************************************************
+
+/**
+ *  @brief   Configures a GPIO pin as a very high speed FSMC (AF12) pin.
+ *  @param   port: The GPIO port of the pin.
+ *  @param   pin: The pin number.
+ *  @returns None.
+ */
+static inline void fsmc_pin_init(GPIO_TypeDef * port, uint8_t pin);
+
+/**
+ *  @brief   Initializes GPIO associated with the FSMC.
+ *  @param   None.
+ *  @returns None.
+ */
+static inline void fsmc_gpio_init(void);
+
+/**
+ *  @brief   Starts a memory to FSMC DMA transfer.
+ *  @param   address: The address of the data to be written.
+ *  @param   size: The number of bytes to be written.
+ *  @param   increment: DMA_SxCR_PINC to increment the source address after
+ *                      each byte, 0 to write the same byte repeatedly.
+ *  @param   callback: Function called once the transfer completes.
+ *  @returns None.
+ */
+static void fsmc_dma_start(const uint8_t * address, uint32_t size,
+                           uint32_t increment, fsmc_callback_t callback);
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+static inline void fsmc_pin_init(GPIO_TypeDef * port, uint8_t pin)
+{
+    // Connect pin to AF12 (FSMC)
+    port->AFR[pin >> 3] &= ~(0xFUL << ((pin & 0x07) * 4));
+    port->AFR[pin >> 3] |=  (0xCUL << ((pin & 0x07) * 4));
+
+    // Configure pin as an alternate function I/O
+    port->MODER   &= ~(0x3UL << (pin * 2));
+    port->MODER   |=  (0x2UL << (pin * 2));
+
+    // Configure pin as a very high speed I/O
+    port->OSPEEDR |=  (0x3UL << (pin * 2));
+
+    // Configure pin as push pull
+    port->OTYPER  &= ~(0x1UL << pin);
+
+    // Configure pin as no pull
+    port->PUPDR   &= ~(0x3UL << (pin * 2));
+}
+
+static inline void fsmc_gpio_init(void)
+{
+    // GPIO configuration
+    // PD14 -> D0,  PD15 -> D1,  PD0  -> D2,  PD1 -> D3
+    // PE7  -> D4,  PE8  -> D5,  PE9  -> D6,  PE10 -> D7
+    // PD4  -> NOE (RD)
+    // PD5  -> NWE (WR)
+    // PD7  -> NE1 (CS)
+    // PD11 -> A16 (D/C)
+
+    // Enable GPIOD and GPIOE clocks
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIODEN | RCC_AHB1ENR_GPIOEEN;
+
+    const uint8_t port_d_pins[] = {0, 1, 4, 5, 7, 11, 14, 15};
+    const uint8_t port_e_pins[] = {7, 8, 9, 10};
+
+    for (uint8_t i = 0; i < sizeof(port_d_pins); i++)
+    {
+        fsmc_pin_init(GPIOD, port_d_pins[i]);
+    }
+
+    for (uint8_t i = 0; i < sizeof(port_e_pins); i++)
+    {
+        fsmc_pin_init(GPIOE, port_e_pins[i]);
+    }
+}
+
+void fsmc_init(void)
+{
+    // Enable FSMC and DMA2 peripherals
+    RCC->AHB3ENR |= RCC_AHB3ENR_FSMCEN;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+
+    // Initialize associated FSMC GPIO
+    fsmc_gpio_init();
+
+    // Use bank 1 as an 8-bit wide, non multiplexed SRAM with writes enabled.
+    // BTCR[0] is the control register and BTCR[1] the timing register.
+    FSMC_Bank1->BTCR[0] = FSMC_BCR1_WREN;
+
+    // Mode A timings - ACCMOD = 0
+    FSMC_Bank1->BTCR[1] = (FSMC_ADDRESS_SETUP  << FSMC_BTR1_ADDSET_Pos) |
+                          (FSMC_DATA_SETUP     << FSMC_BTR1_DATAST_Pos) |
+                          (FSMC_BUS_TURNAROUND << FSMC_BTR1_BUSTURN_Pos);
+
+    // Enable memory bank
+    FSMC_Bank1->BTCR[0] |= FSMC_BCR1_MBKEN;
+
+    // Disable the stream and wait for it to stop before configuring it
+    FSMC_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+    while (FSMC_DMA_STREAM->CR & DMA_SxCR_EN);
+
+    // Memory to memory transfers - the "peripheral" port is the source
+    // and the "memory" port is the FSMC data register.
+    // Use byte sized transfers on both sides
+    // Enable transfer complete and transfer error interrupts
+    FSMC_DMA_STREAM->CR = (FSMC_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) |
+                          DMA_SxCR_DIR_1 | DMA_SxCR_PL_1 |
+                          DMA_SxCR_TCIE  | DMA_SxCR_TEIE;
+
+    // Memory to memory transfers require the FIFO, use a full threshold
+    FSMC_DMA_STREAM->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH;
+
+    // Data is always written to the data register of the display
+    FSMC_DMA_STREAM->M0AR = (uint32_t) FSMC_DATA_ADDRESS;
+
+    // Clear any stale interrupt flags
+    FSMC_DMA_IFCR = FSMC_DMA_CLEAR_FLAGS;
+
+    NVIC_EnableIRQ(FSMC_DMA_IRQ);
+}
+
+void fsmc_write_command(uint8_t command)
+{
+    *FSMC_COMMAND_ADDRESS = command;
+}
+
+void fsmc_write_data(uint8_t data)
+{
+    *FSMC_DATA_ADDRESS = data;
+}
+
+uint8_t fsmc_read_data(void)
+{
+    return *FSMC_DATA_ADDRESS;
+}
+
+void fsmc_write_data_buffer(const uint8_t * buffer, uint32_t buffer_size)
+{
+    for (uint32_t i = 0; i < buffer_size; i++)
+    {
+        *FSMC_DATA_ADDRESS = *buffer++;
+    }
+}
+
+void fsmc_write_data_repeat(uint8_t data, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        *FSMC_DATA_ADDRESS = data;
+    }
+}
+
+static void fsmc_dma_start(const uint8_t * address, uint32_t size,
+                           uint32_t increment, fsmc_callback_t callback)
+{
+    // Wait for previous DMA transfer to complete
+    while (g_dma_busy);
+
+    g_dma_busy = 1;
+    g_dma_callback = callback;
+
+    // Clear interrupt flags of the previous transfer
+    FSMC_DMA_IFCR = FSMC_DMA_CLEAR_FLAGS;
+
+    // Select source address increment mode
+    FSMC_DMA_STREAM->CR = (FSMC_DMA_STREAM->CR & ~DMA_SxCR_PINC) | increment;
+
+    // Select the data to be written
+    FSMC_DMA_STREAM->PAR  = (uint32_t) address;
+    FSMC_DMA_STREAM->NDTR = size;
+
+    // Start transfer
+    FSMC_DMA_STREAM->CR |= DMA_SxCR_EN;
+}
+
+void fsmc_write_data_buffer_dma(const uint8_t * buffer, uint32_t buffer_size,
+                                fsmc_callback_t callback)
+{
+    fsmc_dma_start(buffer, buffer_size, DMA_SxCR_PINC, callback);
+}
+
+void fsmc_write_data_repeat_dma(const uint8_t * data, uint32_t count,
+                                fsmc_callback_t callback)
+{
+    // Keep writing the same byte by not incrementing the source address
+    fsmc_dma_start(data, count, 0, callback);
+}
+
+uint8_t fsmc_dma_busy(void)
+{
+    return g_dma_busy;
+}
+
+// ****************************************************************************
+// * Interrupt Handlers
+// ****************************************************************************
+
+void DMA2_Stream0_IRQHandler(void)
+{
+    if ((FSMC_DMA_ISR & (FSMC_DMA_TC_FLAG | FSMC_DMA_TE_FLAG)) == 0)
+    {
+        return;
+    }
+
+    FSMC_DMA_IFCR = FSMC_DMA_CLEAR_FLAGS;
+
+    g_dma_busy = 0;
+
+    if (g_dma_callback != NULL)
+    {
+        g_dma_callback();
+    }
+}
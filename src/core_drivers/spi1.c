@@ -4,16 +4,77 @@
  *  @brief  A driver for the SPI1 module of the stm32f407vgt6 microcontroller.
  * 
  *          This driver implements blocking routines for receiving and
- *          transmitting data via the SPI1 peripheral.
+ *          transmitting data via the SPI1 peripheral, as well as a
+ *          non-blocking DMA routine for transmitting large buffers.
+ *          Bulk transmissions can use 16-bit frames to halve the number of
+ *          data register writes and DMA requests. Where no DMA stream is
+ *          available, a TXE interrupt driven queue of tagged segments
+ *          provides non-blocking transmissions.
  */
 
 // ****************************************************************************
 // * Included Files
 // ****************************************************************************
 
+#include <stddef.h>
+#include <string.h>
 #include "spi1.h"
 #include "stm32f407xx.h"
 
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// Halfword sized transfers on both sides of the DMA stream
+#define SPI_DMA_HALFWORD    (DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0)
+
+// State of the data / command line before the queue first drives it
+#define SPI_LINE_UNKNOWN    0xFF
+
+// ****************************************************************************
+// * Module Data Structures
+// ****************************************************************************
+
+// A segment of the transmit queue
+typedef struct
+{
+    // Referenced bytes, NULL if the bytes are held in "bytes"
+    const uint8_t * buffer;
+    uint32_t length;
+    // Called by RELEASE and NOTIFY segments
+    spi1_callback_t callback;
+    uint8_t tag;
+    uint8_t bytes[SPI_QUEUE_INLINE_SIZE];
+} spi1_segment_t;
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Set while a DMA transmission is in progress
+static volatile uint8_t g_dma_busy = 0;
+// Set when the last DMA transmission ended with a transfer error
+static volatile uint8_t g_dma_error = 0;
+// Function to call once the current DMA transmission completes
+static volatile spi1_callback_t g_dma_callback = NULL;
+// Currently selected data frame format
+static uint8_t g_frame_format = SPI_FRAME_8BIT;
+
+// Transmit queue, filled at the head and drained at the tail by the
+// SPI1 interrupt
+static spi1_segment_t g_queue[SPI_QUEUE_SIZE];
+static volatile uint32_t g_queue_head = 0;
+static volatile uint32_t g_queue_tail = 0;
+// Number of bytes of the tail segment sent so far
+static uint32_t g_queue_offset = 0;
+// Select lines driven by the queue and their current state
+static spi1_line_t g_queue_select = NULL;
+static spi1_line_t g_queue_data_command = NULL;
+static uint8_t g_queue_selected = 0;
+static uint8_t g_queue_line = SPI_LINE_UNKNOWN;
+// Transmit queue statistics
+static volatile spi1_queue_stats_t g_queue_stats = {0};
+
 // ****************************************************************************
 // * Function Prototypes of Private Functions
 // ****************************************************************************
@@ -40,6 +101,34 @@ static inline void spi1_cr1_init(uint8_t mode);
  */
 static inline void spi1_cr2_init(void);
 
+/**
+ *  @brief   Starts a DMA transmission via the SPI1 peripheral.
+ *  @param   address: The address of the data to be transmitted.
+ *  @param   size: The number of frames to be transmitted.
+ *  @param   mode: DMA_SxCR_MINC to increment the memory address after
+ *                 each frame, 0 to send the same frame repeatedly.
+ *                 Add SPI_DMA_HALFWORD for 16-bit frames.
+ *  @param   callback: Function called once the transfer completes.
+ *  @returns None.
+ */
+static void spi1_dma_start(const void * address, uint32_t size,
+                           uint32_t mode, spi1_callback_t callback);
+
+/**
+ *  @brief   Waits for a free transmit queue segment.
+ *  @param   None.
+ *  @returns The segment at the head of the queue.
+ */
+static spi1_segment_t * spi1_queue_reserve(void);
+
+/**
+ *  @brief   Hands the segment at the head of the queue to the SPI1
+ *           interrupt.
+ *  @param   None.
+ *  @returns None.
+ */
+static void spi1_queue_commit(void);
+
 // ****************************************************************************
 // * Module APIs
 // ****************************************************************************
@@ -133,6 +222,8 @@ static inline void spi1_cr1_init(uint8_t mode)
     SPI_INSTANCE->CR1 &= ~(SPI_CR1_DFF    | SPI_CR1_LSBFIRST | SPI_CR1_CRCEN | 
                            SPI_CR1_RXONLY | SPI_CR1_BIDIMODE);            
 
+    g_frame_format = SPI_FRAME_8BIT;
+
     // Enable SPI1
     SPI_INSTANCE->CR1 |= SPI_CR1_SPE;
 }
@@ -187,6 +278,106 @@ uint8_t spi1_transceive(uint8_t data)
     return received_data;
 }
 
+void spi1_write(uint8_t data)
+{
+    // Wait for previous transfer to complete
+    while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0);
+
+    // Send data
+    SPI_INSTANCE->DR = (uint32_t) data;
+}
+
+void spi1_wait_idle(void)
+{
+    // Wait for last transfer to complete
+    while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0 || \
+           (SPI_INSTANCE->SR & SPI_SR_BSY));
+
+    // Clear the overrun flag because we don't need to read the DR here.
+    // This is done by reading the data register and then the status register.
+    uint8_t data __attribute__((unused)) = SPI_INSTANCE->DR;
+    data = SPI_INSTANCE->SR;
+}
+
+void spi1_set_frame_format(uint8_t frame_format)
+{
+    if (frame_format == g_frame_format)
+    {
+        return;
+    }
+
+    // DFF may only be changed while SPI1 is disabled
+    spi1_wait_idle();
+    SPI_INSTANCE->CR1 &= ~SPI_CR1_SPE;
+
+    if (frame_format == SPI_FRAME_16BIT)
+    {
+        SPI_INSTANCE->CR1 |=  SPI_CR1_DFF;
+    }
+    else
+    {
+        SPI_INSTANCE->CR1 &= ~SPI_CR1_DFF;
+    }
+
+    SPI_INSTANCE->CR1 |= SPI_CR1_SPE;
+
+    g_frame_format = frame_format;
+}
+
+void spi1_write16(uint16_t data)
+{
+    // Wait for previous transfer to complete
+    while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0);
+
+    // Send data
+    SPI_INSTANCE->DR = (uint32_t) data;
+}
+
+void spi1_transmit_buffer16(const uint8_t * buffer, uint32_t frame_count)
+{
+    for (uint32_t i = 0; i < frame_count; i++)
+    {
+        // The first byte goes out first since frames are sent MSB first
+        uint32_t data = ((uint32_t) buffer[0] << 8) | buffer[1];
+        buffer += 2;
+
+        // Wait for previous transfer to complete
+        while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0);
+
+        // Send data
+        SPI_INSTANCE->DR = data;
+    }
+
+    spi1_wait_idle();
+}
+
+void spi1_transmit_repeat16(uint16_t data, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        // Wait for previous transfer to complete
+        while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0);
+
+        // Send data
+        SPI_INSTANCE->DR = (uint32_t) data;
+    }
+
+    spi1_wait_idle();
+}
+
+void spi1_transmit_repeat(uint8_t data, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        // Wait for previous transfer to complete
+        while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0);
+
+        // Send data
+        SPI_INSTANCE->DR = (uint32_t) data;
+    }
+
+    spi1_wait_idle();
+}
 
 void spi1_transmit_buffer(uint8_t * buffer, uint32_t buffer_size)
 {
@@ -199,14 +390,7 @@ void spi1_transmit_buffer(uint8_t * buffer, uint32_t buffer_size)
         SPI_INSTANCE->DR = *buffer++;
     }
 
-    // Wait for last transfer to complete
-    while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0 || \
-           (SPI_INSTANCE->SR & SPI_SR_BSY));
-
-    // Clear the overrun flag because we don't need to read the DR here.
-    // This is done by reading the data register and then the status register.
-    uint8_t data __attribute__((unused)) = SPI_INSTANCE->DR;
-    data = SPI_INSTANCE->SR;
+    spi1_wait_idle();
 }
 
 void spi1_receive_buffer(uint8_t * buffer, uint32_t buffer_size)
@@ -253,4 +437,371 @@ void spi1_transceive_buffer(uint8_t * tx_buffer, uint8_t * rx_buffer,
     // Wait for last transfer to complete
     while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0 || \
            (SPI_INSTANCE->SR & SPI_SR_BSY));
-}
\ No newline at end of file
+}
+
+static void spi1_dma_start(const void * address, uint32_t size,
+                           uint32_t mode, spi1_callback_t callback)
+{
+    // Wait for previous DMA transfer to complete
+    while (g_dma_busy);
+
+    g_dma_busy = 1;
+    g_dma_error = 0;
+    g_dma_callback = callback;
+
+    // Clear interrupt flags of the previous transfer
+    SPI_TX_DMA_IFCR = SPI_TX_DMA_CLEAR_FLAGS;
+
+    // Select memory address increment mode and transfer size
+    SPI_TX_DMA_STREAM->CR = (SPI_TX_DMA_STREAM->CR &
+                             ~(DMA_SxCR_MINC | SPI_DMA_HALFWORD)) | mode;
+
+    // Select the data to be transmitted
+    SPI_TX_DMA_STREAM->M0AR = (uint32_t) address;
+    SPI_TX_DMA_STREAM->NDTR = size;
+
+    // Let SPI1 request data from the DMA whenever TXE is set
+    SPI_INSTANCE->CR2 |= SPI_CR2_TXDMAEN;
+
+    // Start transfer
+    SPI_TX_DMA_STREAM->CR |= DMA_SxCR_EN;
+}
+
+void spi1_dma_init(void)
+{
+    // Enable DMA2 peripheral
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+
+    // Disable the stream and wait for it to stop before configuring it
+    SPI_TX_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+    while (SPI_TX_DMA_STREAM->CR & DMA_SxCR_EN);
+
+    // Select the SPI1_TX channel
+    // Transfer from memory to peripheral
+    // Increment the memory address after each byte
+    // Use byte sized transfers on both sides
+    // Use a high priority
+    // Enable transfer complete and transfer error interrupts
+    SPI_TX_DMA_STREAM->CR = (SPI_TX_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) |
+                            DMA_SxCR_DIR_0 | DMA_SxCR_MINC | DMA_SxCR_PL_1 |
+                            DMA_SxCR_TCIE  | DMA_SxCR_TEIE;
+
+    // Use direct mode - the FIFO is not needed for byte transfers
+    SPI_TX_DMA_STREAM->FCR &= ~DMA_SxFCR_DMDIS;
+
+    // Data is always written to the SPI1 data register
+    SPI_TX_DMA_STREAM->PAR = (uint32_t) &SPI_INSTANCE->DR;
+
+    // Clear any stale interrupt flags
+    SPI_TX_DMA_IFCR = SPI_TX_DMA_CLEAR_FLAGS;
+
+    NVIC_EnableIRQ(SPI_TX_DMA_IRQ);
+}
+
+void spi1_transmit_buffer_dma(const uint8_t * buffer, uint32_t buffer_size,
+                              spi1_callback_t callback)
+{
+    spi1_dma_start(buffer, buffer_size, DMA_SxCR_MINC, callback);
+}
+
+void spi1_transmit_repeat_dma(const uint8_t * data, uint32_t count,
+                              spi1_callback_t callback)
+{
+    // Keep sending the same byte by not incrementing the memory address
+    spi1_dma_start(data, count, 0, callback);
+}
+
+uint8_t spi1_dma_busy(void)
+{
+    return g_dma_busy;
+}
+
+uint8_t spi1_dma_error(void)
+{
+    return g_dma_error;
+}
+
+void spi1_transmit_buffer16_dma(const uint16_t * buffer, uint32_t frame_count,
+                                spi1_callback_t callback)
+{
+    spi1_dma_start(buffer, frame_count, DMA_SxCR_MINC | SPI_DMA_HALFWORD,
+                   callback);
+}
+
+void spi1_transmit_repeat16_dma(const uint16_t * data, uint32_t count,
+                                spi1_callback_t callback)
+{
+    // Keep sending the same frame by not incrementing the memory address
+    spi1_dma_start(data, count, SPI_DMA_HALFWORD, callback);
+}
+
+static spi1_segment_t * spi1_queue_reserve(void)
+{
+    uint32_t used = (g_queue_head - g_queue_tail) & (SPI_QUEUE_SIZE - 1);
+
+    if (used == SPI_QUEUE_SIZE - 1)
+    {
+        // Queue is full, wait for the interrupt to drain a segment
+        g_queue_stats.stalls++;
+        while (((g_queue_head - g_queue_tail) & (SPI_QUEUE_SIZE - 1)) ==
+               SPI_QUEUE_SIZE - 1);
+    }
+
+    return &g_queue[g_queue_head];
+}
+
+static void spi1_queue_commit(void)
+{
+    g_queue_head = (g_queue_head + 1) & (SPI_QUEUE_SIZE - 1);
+
+    uint32_t used = (g_queue_head - g_queue_tail) & (SPI_QUEUE_SIZE - 1);
+
+    if (used > g_queue_stats.high_water)
+    {
+        g_queue_stats.high_water = used;
+    }
+
+    // Let the interrupt drain the queue
+    SPI_INSTANCE->CR2 |= SPI_CR2_TXEIE;
+}
+
+void spi1_queue_init(spi1_line_t select, spi1_line_t data_command)
+{
+    // Disable the interrupt before resetting the queue
+    SPI_INSTANCE->CR2 &= ~SPI_CR2_TXEIE;
+
+    g_queue_select = select;
+    g_queue_data_command = data_command;
+    g_queue_selected = 0;
+    g_queue_line = SPI_LINE_UNKNOWN;
+
+    g_queue_head = 0;
+    g_queue_tail = 0;
+    g_queue_offset = 0;
+
+    spi1_queue_reset_stats();
+
+    NVIC_EnableIRQ(SPI1_IRQn);
+}
+
+void spi1_queue_push(uint8_t tag, const uint8_t * buffer, uint32_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    spi1_segment_t * segment = spi1_queue_reserve();
+
+    segment->buffer = buffer;
+    segment->length = length;
+    segment->callback = NULL;
+    segment->tag = tag;
+
+    spi1_queue_commit();
+}
+
+void spi1_queue_push_copy(uint8_t tag, const uint8_t * bytes, uint32_t length)
+{
+    while (length > 0)
+    {
+        uint32_t size = (length < SPI_QUEUE_INLINE_SIZE) ?
+                        length : SPI_QUEUE_INLINE_SIZE;
+
+        spi1_segment_t * segment = spi1_queue_reserve();
+
+        memcpy(segment->bytes, bytes, size);
+        segment->buffer = NULL;
+        segment->length = size;
+        segment->callback = NULL;
+        segment->tag = tag;
+
+        spi1_queue_commit();
+
+        bytes += size;
+        length -= size;
+    }
+}
+
+void spi1_queue_push_repeat(uint8_t tag, uint8_t data, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    spi1_segment_t * segment = spi1_queue_reserve();
+
+    segment->bytes[0] = data;
+    segment->buffer = NULL;
+    segment->length = count;
+    segment->callback = NULL;
+    segment->tag = tag | SPI_SEGMENT_REPEAT;
+
+    spi1_queue_commit();
+}
+
+void spi1_queue_release(spi1_callback_t callback)
+{
+    spi1_segment_t * segment = spi1_queue_reserve();
+
+    segment->buffer = NULL;
+    segment->length = 0;
+    segment->callback = callback;
+    segment->tag = SPI_SEGMENT_RELEASE;
+
+    spi1_queue_commit();
+}
+
+void spi1_queue_notify(spi1_callback_t callback)
+{
+    spi1_segment_t * segment = spi1_queue_reserve();
+
+    segment->buffer = NULL;
+    segment->length = 0;
+    segment->callback = callback;
+    segment->tag = SPI_SEGMENT_NOTIFY;
+
+    spi1_queue_commit();
+}
+
+uint8_t spi1_queue_busy(void)
+{
+    return (g_queue_head != g_queue_tail);
+}
+
+void spi1_queue_flush(void)
+{
+    while (g_queue_head != g_queue_tail);
+
+    spi1_wait_idle();
+}
+
+void spi1_queue_get_stats(spi1_queue_stats_t * stats)
+{
+    stats->high_water = g_queue_stats.high_water;
+    stats->stalls = g_queue_stats.stalls;
+}
+
+void spi1_queue_reset_stats(void)
+{
+    g_queue_stats.high_water = 0;
+    g_queue_stats.stalls = 0;
+}
+
+// ****************************************************************************
+// * Interrupt Handlers
+// ****************************************************************************
+
+void DMA2_Stream3_IRQHandler(void)
+{
+    uint32_t flags = SPI_TX_DMA_ISR;
+
+    if ((flags & (SPI_TX_DMA_TC_FLAG | SPI_TX_DMA_TE_FLAG)) == 0)
+    {
+        return;
+    }
+
+    SPI_TX_DMA_IFCR = SPI_TX_DMA_CLEAR_FLAGS;
+
+    // The stream is released either way, the error is latched for the
+    // callback to check
+    if (flags & SPI_TX_DMA_TE_FLAG)
+    {
+        g_dma_error = 1;
+    }
+
+    // The DMA completes once the last byte is written into the data
+    // register, wait for the last byte to be shifted out.
+    while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0 || \
+           (SPI_INSTANCE->SR & SPI_SR_BSY));
+
+    SPI_INSTANCE->CR2 &= ~SPI_CR2_TXDMAEN;
+
+    // Clear the overrun flag because we don't need to read the DR here.
+    // This is done by reading the data register and then the status register.
+    uint8_t data __attribute__((unused)) = SPI_INSTANCE->DR;
+    data = SPI_INSTANCE->SR;
+
+    g_dma_busy = 0;
+
+    if (g_dma_callback != NULL)
+    {
+        g_dma_callback();
+    }
+}
+
+void SPI1_IRQHandler(void)
+{
+    while (g_queue_tail != g_queue_head)
+    {
+        spi1_segment_t * segment = &g_queue[g_queue_tail];
+        uint8_t tag = segment->tag & ~SPI_SEGMENT_REPEAT;
+
+        if ((tag == SPI_SEGMENT_RELEASE) || (tag == SPI_SEGMENT_NOTIFY))
+        {
+            // Wait for the last byte to be shifted out
+            while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0 || \
+                   (SPI_INSTANCE->SR & SPI_SR_BSY));
+
+            if ((tag == SPI_SEGMENT_RELEASE) && g_queue_selected)
+            {
+                g_queue_select(0);
+                g_queue_selected = 0;
+            }
+
+            g_queue_tail = (g_queue_tail + 1) & (SPI_QUEUE_SIZE - 1);
+
+            // The callback may queue more segments
+            if (segment->callback != NULL)
+            {
+                segment->callback();
+            }
+
+            continue;
+        }
+
+        if ((g_queue_line != tag) || !g_queue_selected)
+        {
+            // Select lines only change once the last byte is shifted out
+            while ((SPI_INSTANCE->SR & SPI_SR_TXE) == 0 || \
+                   (SPI_INSTANCE->SR & SPI_SR_BSY));
+
+            if (g_queue_line != tag)
+            {
+                g_queue_data_command(tag == SPI_SEGMENT_DATA);
+                g_queue_line = tag;
+            }
+
+            if (!g_queue_selected)
+            {
+                g_queue_select(1);
+                g_queue_selected = 1;
+            }
+        }
+
+        const uint8_t * bytes = (segment->buffer != NULL) ?
+                                segment->buffer : segment->bytes;
+
+        // Send one byte per TXE interrupt
+        if (segment->tag & SPI_SEGMENT_REPEAT)
+        {
+            SPI_INSTANCE->DR = bytes[0];
+        }
+        else
+        {
+            SPI_INSTANCE->DR = bytes[g_queue_offset];
+        }
+
+        if (++g_queue_offset == segment->length)
+        {
+            g_queue_offset = 0;
+            g_queue_tail = (g_queue_tail + 1) & (SPI_QUEUE_SIZE - 1);
+        }
+
+        return;
+    }
+
+    // Nothing left to send
+    SPI_INSTANCE->CR2 &= ~SPI_CR2_TXEIE;
+}
@@ -0,0 +1,108 @@
+/**
+ *  @file   tim2.c
+ *  @author Adom Kwabena
+ *  @brief  A driver for the TIM2 general purpose timer of the stm32f407vgt6
+ *          microcontroller.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stddef.h>
+#include "tim2.h"
+#include "stm32f407xx.h"
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Function to call on every tick
+static volatile tim2_callback_t g_tim2_callback = NULL;
+
+// ****************************************************************************
+// * Private Functions
+// ****************************************************************************
+
+/**
+ *  @brief   Converts a period into timer clocks.
+ *  @param   period_ns: The period in nanoseconds.
+ *  @returns The auto-reload value of the period.
+ */
+static inline uint32_t tim2_reload(uint32_t period_ns)
+{
+    uint32_t clocks = (uint32_t) (((uint64_t) period_ns * TIM2_CLOCK_HZ) /
+                                  1000000000ULL);
+
+    return (clocks > 1) ? (clocks - 1) : 1;
+}
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+void tim2_start(uint32_t period_ns, tim2_callback_t callback)
+{
+    // Enable TIM2 clock
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+
+    TIM2->CR1 = 0;
+    g_tim2_callback = callback;
+
+    // Count the kernel clock directly
+    TIM2->PSC = 0;
+    TIM2->ARR = tim2_reload(period_ns);
+    TIM2->CNT = 0;
+
+    // Load the prescaler and clear the update flag it raises
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->SR = 0;
+
+    TIM2->DIER = TIM_DIER_UIE;
+    NVIC_EnableIRQ(TIM2_IRQn);
+
+    // Buffer the auto-reload value, so period changes wait for a tick
+    TIM2->CR1 = TIM_CR1_ARPE | TIM_CR1_CEN;
+}
+
+void tim2_set_period(uint32_t period_ns)
+{
+    TIM2->ARR = tim2_reload(period_ns);
+}
+
+void tim2_restart(void)
+{
+    // Reload the counter without raising a tick
+    TIM2->CR1 |= TIM_CR1_URS;
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->CR1 &= ~TIM_CR1_URS;
+}
+
+void tim2_stop(void)
+{
+    TIM2->CR1 &= ~TIM_CR1_CEN;
+    TIM2->DIER = 0;
+    TIM2->SR = 0;
+    NVIC_DisableIRQ(TIM2_IRQn);
+
+    g_tim2_callback = NULL;
+}
+
+// ****************************************************************************
+// * Interrupt Handlers
+// ****************************************************************************
+
+void TIM2_IRQHandler(void)
+{
+    if ((TIM2->SR & TIM_SR_UIF) == 0)
+    {
+        return;
+    }
+
+    TIM2->SR = ~((uint32_t) TIM_SR_UIF);
+
+    if (g_tim2_callback != NULL)
+    {
+        g_tim2_callback();
+    }
+}
@@ -5,8 +5,27 @@
  */
 
 #include <stddef.h>
-#include "spi1.h"
+#include <string.h>
 #include "ssd1322.h"
+#include "ssd1322_transport.h"
+
+#if SSD1322_HOST_BUILD
+#include <time.h>
+#else
+#include "crc.h"
+#include "stm32f407xx.h"
+#endif
+
+#if SSD1322_FB_FILL_DMA_BYTES > 0
+#include "dma2.h"
+#endif
+
+// Blending uses the SIMD instructions of the Cortex-M4 where available
+#if !SSD1322_HOST_BUILD && defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define SSD1322_SIMD    1
+#else
+#define SSD1322_SIMD    0
+#endif
 
 // ****************************************************************************
 // * Module Global Variables
@@ -14,608 +33,2372 @@
 
 const font_t *g_active_font = NULL;
 
+// Bus used to talk to the SSD1322
+#if SSD1322_BUS == SSD1322_BUS_FSMC
+static const ssd1322_transport_t *g_transport = &ssd1322_transport_fsmc;
+#elif SSD1322_BUS == SSD1322_BUS_HOST
+static const ssd1322_transport_t *g_transport = &ssd1322_transport_host;
+#elif SSD1322_BUS == SSD1322_BUS_SPI_IRQ
+static const ssd1322_transport_t *g_transport = &ssd1322_transport_spi1_irq;
+#else
+static const ssd1322_transport_t *g_transport = &ssd1322_transport_spi1_dma;
+#endif
+
+// Set while a frame buffer is being transferred by DMA
+static volatile uint8_t g_fb_transfer_busy = 0;
+// Function to call once the current frame buffer transfer completes
+static volatile ssd1322_callback_t g_fb_transfer_callback = NULL;
+
+// Re-map format of the selected orientation
+static uint8_t g_remap_format = REMAP_DEFAULT;
+
+// Segment output current last set
+static uint8_t g_contrast_current = DEFAULT_CONTRAST_CURRENT;
+static uint8_t g_master_current = DEFAULT_MASTER_CURRENT;
+
+// Scan timing in use
+static ssd1322_refresh_profile_t g_refresh_profile;
+
+const ssd1322_refresh_profile_t ssd1322_profile_default =
+{
+    .display_clock = 0xF1,
+    .phase_length = 0xE2,
+    .multiplex_rows = 64,
+    .partial = 0,
+    .partial_start = 0,
+    .partial_end = 0
+};
+
+const ssd1322_refresh_profile_t ssd1322_profile_fast =
+{
+    .display_clock = 0xF0,
+    .phase_length = 0xE2,
+    .multiplex_rows = 64,
+    .partial = 0,
+    .partial_start = 0,
+    .partial_end = 0
+};
+
+const ssd1322_refresh_profile_t ssd1322_profile_idle =
+{
+    .display_clock = 0xF2,
+    .phase_length = 0xE2,
+    .multiplex_rows = 64,
+    .partial = 0,
+    .partial_start = 0,
+    .partial_end = 0
+};
+
+// Display mode last selected
+static uint8_t g_display_mode = DISPLAY_MODE_NORMAL;
+
+// Gray scale table in use, only valid while a custom table is enabled
+static uint8_t g_gray_table[GRAY_SCALE_TABLE_SIZE];
+static uint8_t g_gray_table_custom = 0;
+
+const uint8_t ssd1322_gray_table_linear[GRAY_SCALE_TABLE_SIZE] =
+{
+    0x0C, 0x18, 0x24, 0x30, 0x3C, 0x48, 0x54, 0x60,
+    0x6C, 0x78, 0x84, 0x90, 0x9C, 0xA8, 0xB4
+};
+
+const uint8_t ssd1322_gray_table_gamma[GRAY_SCALE_TABLE_SIZE] =
+{
+    0x01, 0x02, 0x05, 0x0A, 0x10, 0x18, 0x22, 0x2D,
+    0x3B, 0x4A, 0x5B, 0x6E, 0x83, 0x9B, 0xB4
+};
+
+// First GDDRAM row of the page being displayed (0 or BUFFER_HEIGHT)
+static volatile uint8_t g_page_row = 0;
+// Set when frames are uploaded into the hidden page and flipped in
+static uint8_t g_page_flip = 0;
+// Set while an asynchronous transfer has to flip pages once it completes,
+// the flip is sent from thread context by "ssd1322_wait_transfer()"
+static uint8_t g_flip_pending = 0;
+
+// Regions of the frame buffer changed since the last partial flush
+static ssd1322_rect_t g_dirty[SSD1322_DIRTY_RECTS];
+static uint8_t g_dirty_count = 0;
+
+// Segment hashes of the last content-diff flush
+#define DIFF_SEGMENTS   (BUFFER_WIDTH / SSD1322_DIFF_SEGMENT_BYTES)
+static uint32_t g_diff_hash[BUFFER_HEIGHT][DIFF_SEGMENTS];
+// Cleared when the GDDRAM no longer matches the hashes
+static uint8_t g_diff_valid = 0;
+static ssd1322_diff_stats_t g_diff_stats = {0};
+
+#if SSD1322_FB_FILL_DMA_BYTES > 0
+// Set once DMA2 is configured for frame buffer fills
+static uint8_t g_fill_dma_ready = 0;
+#endif
+
+// Row being streamed by immediate mode drawing
+static uint8_t g_line[BUFFER_WIDTH];
+
+// Blending of resources drawn into frame buffers
+static uint8_t g_blend_mode = BLEND_COPY;
+// Alpha as a weight out of 16, and the transparent key in every byte lane
+static uint32_t g_blend_weight = 16;
+static uint32_t g_blend_key = 0;
+// Resource row shifted to an odd pixel column before it is blended
+static uint8_t g_blend_row[BUFFER_WIDTH];
+
+// Surface the *_fb functions draw through, bound to the last frame buffer
+static uint8_t *g_fb_rows[BUFFER_HEIGHT];
+static ssd1322_surface_t g_fb_surface =
+{
+    .rows = g_fb_rows,
+    .x_byte = 0,
+    .width = DISPLAY_WIDTH,
+    .height = BUFFER_HEIGHT,
+    .stride = BUFFER_WIDTH,
+    .bpp = SURFACE_BPP,
+    .clip_x_start = 0,
+    .clip_x_end = DISPLAY_WIDTH - 1,
+    .clip_y_start = 0,
+    .clip_y_end = BUFFER_HEIGHT - 1,
+    .track_dirty = 1,
+    .fb_column = 0,
+    .fb_row = 0
+};
+
 // ****************************************************************************
 // * Private Functions
 // ****************************************************************************
 
+/**
+ * @brief   This function reads a free running counter used to time the
+ *          driver, the DWT cycle counter or a nanosecond clock on a host.
+ *
+ * @param   None
+ * @returns The counter value.
+ */
+static inline uint32_t ssd1322_timestamp(void)
+{
+#if SSD1322_HOST_BUILD
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t) (((uint64_t) now.tv_sec * 1000000000ULL) + now.tv_nsec);
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+/**
+ * @brief   This function computes the CRC-32 of a block of words, on the
+ *          CRC unit or in software on a host. Both use the polynomial
+ *          0x04C11DB7 with words fed MSB first from 0xFFFFFFFF.
+ *
+ * @param   words: The words, word aligned.
+ * @param   count: The number of words.
+ * @returns The CRC of the block.
+ */
+static inline uint32_t ssd1322_hash(const uint32_t *words, uint32_t count)
+{
+#if SSD1322_HOST_BUILD
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    while (count--)
+    {
+        crc ^= *words++;
+
+        for (uint8_t i = 0; i < 32; i++)
+        {
+            crc = (crc & 0x80000000UL) ? ((crc << 1) ^ 0x04C11DB7UL) : (crc << 1);
+        }
+    }
+
+    return crc;
+#else
+    return crc_compute(words, count);
+#endif
+}
+
+/**
+ * @brief   This function reads a word from an address which may not be
+ *          word aligned.
+ *
+ * @param   bytes: The first byte of the word.
+ * @returns The word.
+ */
+static inline uint32_t ssd1322_read_word(const uint8_t *bytes)
+{
+#if SSD1322_HOST_BUILD
+    uint32_t word;
+
+    memcpy(&word, bytes, sizeof(word));
+
+    return word;
+#else
+    return __UNALIGNED_UINT32_READ(bytes);
+#endif
+}
+
+/**
+ * @brief   This function keeps the larger pixel of every byte lane. The
+ *          pixels are in the upper half of each lane.
+ *
+ * @param   a: The first pixels.
+ * @param   b: The second pixels.
+ * @returns The larger pixels.
+ */
+static inline uint32_t ssd1322_lanes_max(uint32_t a, uint32_t b)
+{
+#if SSD1322_SIMD
+    // USUB8 sets a GE flag for each lane where a >= b and SEL picks those
+    // lanes from a
+    __USUB8(a, b);
+    return __SEL(a, b);
+#else
+    // Bit 4 of (16 + a - b) is set where a >= b, lanes never borrow
+    uint32_t ge = ((((a >> 4) | 0x10101010UL) - (b >> 4)) >> 4) & 0x01010101UL;
+    uint32_t mask = ge * 0xF0;
+
+    return (a & mask) | (b & ~mask);
+#endif
+}
+
+/**
+ * @brief   This function adds the pixels of every byte lane, saturating at
+ *          gray level 15. The pixels are in the upper half of each lane.
+ *
+ * @param   a: The first pixels.
+ * @param   b: The second pixels.
+ * @returns The sums, in the upper half of each lane.
+ */
+static inline uint32_t ssd1322_lanes_add(uint32_t a, uint32_t b)
+{
+#if SSD1322_SIMD
+    // In the upper half of a byte lane, saturating at 0xFF is saturating
+    // at gray level 15
+    return __UQADD8(a, b) & 0xF0F0F0F0UL;
+#else
+    // Sums of two pixels fit in 5 bits, bit 4 flags an overflow
+    uint32_t sum = (a >> 4) + (b >> 4);
+    uint32_t overflow = ((sum >> 4) & 0x01010101UL) * 0x0F;
+
+    return ((sum | overflow) & 0x0F0F0F0FUL) << 4;
+#endif
+}
+
+/**
+ * @brief   This function picks every byte lane from one of two words,
+ *          depending on whether the lane of a selector is zero.
+ *
+ * @param   selector: Pixels in the lower half of each lane.
+ * @param   zero: The lanes picked where the selector is zero.
+ * @param   other: The lanes picked elsewhere.
+ * @returns The picked lanes.
+ */
+static inline uint32_t ssd1322_lanes_select_zero(uint32_t selector,
+                                                 uint32_t zero,
+                                                 uint32_t other)
+{
+#if SSD1322_SIMD
+    // 0 - selector only leaves the GE flag of a lane set if it is zero
+    __USUB8(0, selector);
+    return __SEL(zero, other);
+#else
+    // Bit 4 of (15 + selector) is set where the selector is not zero
+    uint32_t mask = (((selector + 0x0F0F0F0FUL) >> 4) & 0x01010101UL) * 0xFF;
+
+    return (other & mask) | (zero & ~mask);
+#endif
+}
+
 /**
  * @brief   This function is used to select the SSD1322 GDDRAM address
  *          increment mode and remap of OLED display segments to memory
  *          locations in GDDRAM.
  *
+ * @param   stream: The command stream to append to.
  * @param   format: The type of remap format required - refer to the
  *                  SSD1322 datasheet for various remap formats available.
  * @returns None
  */
-static inline void ssd1322_set_remap_format(uint8_t format)
+static inline void ssd1322_set_remap_format(ssd1322_stream_t *stream,
+                                            uint8_t format)
 {
     // Set Re-Map/Dual COM line mode
-    ssd1322_write_command(SET_REMAP_DUAL_COM_LINE_MODE);
+    ssd1322_stream_command(stream, SET_REMAP_DUAL_COM_LINE_MODE);
     // Default => 0x40
-    ssd1322_write_data(format);
+    ssd1322_stream_data(stream, format);
     // Default => 0x01 (Disable dual COM mode)
-    ssd1322_write_data(0x11);
+    ssd1322_stream_data(stream, 0x11);
 }
 
 /**
  * @brief   This function specifies a vertical offset by mapping the display
  *          start line to one of the COM0-127 rows.
+ * @param   stream: The command stream to append to.
  * @param   offset: The vertical offset required.
  * @returns None
  */
-static inline void ssd1322_set_display_offset(uint8_t offset)
+static inline void ssd1322_set_display_offset(ssd1322_stream_t *stream,
+                                              uint8_t offset)
 {
     // Set vertical scroll by ROW
-    ssd1322_write_command(SET_DISPLAY_OFFSET);
+    ssd1322_stream_command(stream, SET_DISPLAY_OFFSET);
     // Default => 0x00
-    ssd1322_write_data(offset);
+    ssd1322_stream_data(stream, offset);
 }
 
 /**
  * @brief   This function provides the means to select one of four display
  *          configurations which are:
- *          1. Normal display [0xA4]
+ *          1. Set Entire Display OFF [0xA4]
  *          2. Set Entire Display ON [0xA5]
- *          3. Set Entire Display OFF [0xA6]
+ *          3. Normal display [0xA6]
  *          4. Inverse Display [0xA7]- The gray level of display data are
  *                                     swapped i.e. GS0->GS15, GS1->GS14, ...
  *
- * @param   display_mode: This selects one of the four configurations above.
+ * @param   stream: The command stream to append to.
+ * @param   display_mode: This selects one of the four configurations above
+ *                        (DISPLAY_MODE_*).
  * @returns None
  */
-static inline void ssd1322_set_display_mode(uint8_t display_mode)
+static inline void ssd1322_set_display_mode(ssd1322_stream_t *stream,
+                                            uint8_t display_mode)
 {
-    ssd1322_write_command(SET_DISPLAY_MODE_MASK | display_mode);
+    ssd1322_stream_command(stream, SET_DISPLAY_MODE_MASK | display_mode);
 }
 
 /**
  * @brief   This function displays an area defined by the parameters supplied.
  *
+ * @param   stream: The command stream to append to.
  * @param   partial_mode: Enable or exit partial mode.
  * @param   row_address_start: Initial row address to display.
  * @param   row_address_end: final row address to display.
  *
  * @returns None
  */
-static inline void ssd1322_set_partial_display(uint8_t partial_mode,
+static inline void ssd1322_set_partial_display(ssd1322_stream_t *stream,
+                                               uint8_t partial_mode,
                                                uint8_t row_address_start,
                                                uint8_t row_address_end)
 {
-    ssd1322_write_command(PARTIAL_DISPLAY_MASK | partial_mode);
+    ssd1322_stream_command(stream, PARTIAL_DISPLAY_MASK | partial_mode);
 
     if (partial_mode == ENABLE_PARTIAL_DISPLAY)
     {
-        ssd1322_write_data(row_address_start);
-        ssd1322_write_data(row_address_end);
+        ssd1322_stream_data(stream, row_address_start);
+        ssd1322_stream_data(stream, row_address_end);
     }
 }
 
 /**
  * @brief   This function is used to enable or disable the VDD regulator.
  *
+ * @param   stream: The command stream to append to.
  * @param   function: Enable or disable the internal VDD regulator.
  * @returns None
  */
-static inline void ssd1322_set_function_selection(uint8_t function)
+static inline void ssd1322_set_function_selection(ssd1322_stream_t *stream,
+                                                  uint8_t function)
 {
-    ssd1322_write_command(SET_FUNCTION_SELECTION);
-    ssd1322_write_data(function);
+    ssd1322_stream_command(stream, SET_FUNCTION_SELECTION);
+    ssd1322_stream_data(stream, function);
 }
 
 /**
  * @brief   This function sets the length of phases 1 and 2 of segement
  *          waveforms of the driver.
  *
+ * @param   stream: The command stream to append to.
  * @param   phase_length - The length of Phase 1 is defined by bits [3:0]
  *                       from 5 to 31 in units of 2 display clocks (DCLKs).
  *                       The length of Phase 2 is defined by bits [7:4]
  *                       from 3 to 15 in the unit of display clocks (DCLKs).
  * @returns None
  */
-static inline void ssd1322_set_phase_length(uint8_t phase_length)
+static inline void ssd1322_set_phase_length(ssd1322_stream_t *stream,
+                                            uint8_t phase_length)
 {
-    ssd1322_write_command(SET_PHASE_LENGTH);
-    ssd1322_write_data(phase_length);
+    ssd1322_stream_command(stream, SET_PHASE_LENGTH);
+    ssd1322_stream_data(stream, phase_length);
 }
 
 /**
  * @brief   This function is used to select the frequency of the SSD1322 and
  *          together with other parameters the frame rate of the display.
  *
+ * @param   stream: The command stream to append to.
  * @param   display_clock: Bits [3:0] define the clock divide ratio by a factor
- *                       from 1 to 16.
+ *                       of 2^n from 1 to 1024.
  *                       bits [7:4] define the oscillator frequency. There are
  *                       16 different frequency settings with higher values
  *                       providing higher clock frequencies.
  * @returns None
  */
-static inline void ssd1322_set_display_clock(uint8_t display_clock)
+static inline void ssd1322_set_display_clock(ssd1322_stream_t *stream,
+                                             uint8_t display_clock)
 {
-    ssd1322_write_command(SET_FRONT_CLOCK_DIVIDER);
-    ssd1322_write_data(display_clock);
+    ssd1322_stream_command(stream, SET_FRONT_CLOCK_DIVIDER);
+    ssd1322_stream_data(stream, display_clock);
 }
 
 /**
  * @brief   This function is used to enhance the display performance.
  *
+ * @param   stream: The command stream to append to.
  * @param   vsl: This is used to enable or disable external VSL.
  * @param   gray_scale_quality: This is used to improve the low gray
  *                            scale quality.
  * @returns None
  */
-static inline void ssd1322_set_display_enhancement_a(uint8_t vsl,
+static inline void ssd1322_set_display_enhancement_a(ssd1322_stream_t *stream,
+                                                     uint8_t vsl,
                                                      uint8_t gray_scale_quality)
 {
-    ssd1322_write_command(DISPLAY_ENHANCEMENT_A);
-    ssd1322_write_data(0xA0 | vsl);
-    ssd1322_write_data(0x05 | gray_scale_quality);
+    ssd1322_stream_command(stream, DISPLAY_ENHANCEMENT_A);
+    ssd1322_stream_data(stream, 0xA0 | vsl);
+    ssd1322_stream_data(stream, 0x05 | gray_scale_quality);
 }
 
 /**
  * @brief   This function is used to set the states of the GPIO0 and GPIO1 pins.
+ * @param   stream: The command stream to append to.
  * @param   gpio_mode: Selects the states of GPIO0 and GPIO1 pins.
  * @returns None
  */
-static inline void ssd1322_set_gpio(uint8_t gpio_mode)
+static inline void ssd1322_set_gpio(ssd1322_stream_t *stream, uint8_t gpio_mode)
 {
-    ssd1322_write_command(SET_GPIO);
-    ssd1322_write_data(gpio_mode);
+    ssd1322_stream_command(stream, SET_GPIO);
+    ssd1322_stream_data(stream, gpio_mode);
 }
 
 /**
  * @brief   This function is used to set the phase 3 second pre-charge period.
  *
+ * @param   stream: The command stream to append to.
  * @param   precharge_period: Sets the phase 3 second pre-charge period
  *                          from 0 to 15 display clocks (DCLKs).
  * @returns None
  */
-static inline void ssd1322_set_precharge_period(uint8_t precharge_period)
+static inline void ssd1322_set_precharge_period(ssd1322_stream_t *stream,
+                                                uint8_t precharge_period)
 {
-    ssd1322_write_command(SET_SECOND_PRECHARGE_PERIOD);
-    ssd1322_write_data(precharge_period);
+    ssd1322_stream_command(stream, SET_SECOND_PRECHARGE_PERIOD);
+    ssd1322_stream_data(stream, precharge_period);
 }
 
 /**
  * @brief   This function is used to set the first pre-charge (phase 2) level
  *          of segment pins.
+ * @param   stream: The command stream to append to.
  * @param   precharge_voltage: Selects the precharge voltage with refernce
  *                             to VCC.
  * @returns None
  */
-static inline void ssd1322_set_precharge_voltage(uint8_t precharge_voltage)
+static inline void ssd1322_set_precharge_voltage(ssd1322_stream_t *stream,
+                                                 uint8_t precharge_voltage)
 {
-    ssd1322_write_command(SET_PRECHARGE_VOLTAGE);
-    ssd1322_write_data(precharge_voltage);
+    ssd1322_stream_command(stream, SET_PRECHARGE_VOLTAGE);
+    ssd1322_stream_data(stream, precharge_voltage);
 }
 
 /**
  * @brief   This function sets the de-select level of common pins.
+ * @param   stream: The command stream to append to.
  * @param   vcomh_value: Sets the de-select level of common pins with reference to VCC.
  * @returns None
  */
-static inline void ssd1322_set_vcomh(uint8_t vcomh_value)
+static inline void ssd1322_set_vcomh(ssd1322_stream_t *stream, uint8_t vcomh_value)
 {
-    ssd1322_write_command(SET_VCOMH_VOLTAGE);
-    ssd1322_write_data(vcomh_value);
+    ssd1322_stream_command(stream, SET_VCOMH_VOLTAGE);
+    ssd1322_stream_data(stream, vcomh_value);
 }
 
 /**
  * @brief   This function is used to set the brightness of the display by
  *          setting the segment output current.
  *
+ * @param   stream: The command stream to append to.
  * @param   contrast_current: Selects contrast current / display brightness
  *                          from 0 to 255 in linear steps.
  * @returns None
  */
-static inline void ssd1322_set_contrast_current(uint8_t contrast_current)
+static inline void ssd1322_set_contrast_current(ssd1322_stream_t *stream,
+                                                uint8_t contrast_current)
 {
-    ssd1322_write_command(SET_CONTRAST_CURRENT);
-    ssd1322_write_data(contrast_current);
+    ssd1322_stream_command(stream, SET_CONTRAST_CURRENT);
+    ssd1322_stream_data(stream, contrast_current);
 }
 
 /**
  * @brief   This function controls the brightness of the display with 16 master
  *          control steps.
  *
+ * @param   stream: The command stream to append to.
  * @param   master_current: Sets the brightness of the display by setting the
  *                          master current. Higher values result in a higher
  *                          current and thus brighter display.
  * @returns None
  */
-static inline void ssd1322_set_master_current(uint8_t master_current)
+static inline void ssd1322_set_master_current(ssd1322_stream_t *stream,
+                                              uint8_t master_current)
 {
-    ssd1322_write_command(MASTER_CURRENT_CONTROL);
-    ssd1322_write_data(master_current);
+    ssd1322_stream_command(stream, MASTER_CURRENT_CONTROL);
+    ssd1322_stream_data(stream, master_current);
 }
 
 /**
  * @brief   This function selects the number of common pins (rows) used by the display.
+ * @param   stream: The command stream to append to.
  * @param   multiplex_ratio: The number of rows of the display.
  * @returns None
  */
-static inline void ssd1322_set_multiplex_ratio(uint8_t multiplex_ratio)
+static inline void ssd1322_set_multiplex_ratio(ssd1322_stream_t *stream,
+                                               uint8_t multiplex_ratio)
 {
-    ssd1322_write_command(SET_MULTIPLEX_RATIO);
-    ssd1322_write_data(multiplex_ratio);
+    ssd1322_stream_command(stream, SET_MULTIPLEX_RATIO);
+    ssd1322_stream_data(stream, multiplex_ratio);
 }
 
 /**
  * @brief   This function is used to enhance display performance.
+ * @param   stream: The command stream to append to.
  * @param   display_enhancement_b: Selects the display enhancement.
  * @returns None
  */
-static inline void ssd1322_set_display_enhancement_b(uint8_t display_enhancement_b)
+static inline void ssd1322_set_display_enhancement_b(ssd1322_stream_t *stream,
+                                                     uint8_t display_enhancement_b)
 {
-    ssd1322_write_command(DISPLAY_ENHANCEMENT_B);
-    ssd1322_write_data(0x82 | display_enhancement_b);
-    ssd1322_write_data(0x20);
+    ssd1322_stream_command(stream, DISPLAY_ENHANCEMENT_B);
+    ssd1322_stream_data(stream, 0x82 | display_enhancement_b);
+    ssd1322_stream_data(stream, 0x20);
 }
 
 /**
  *  @brief   Selects a linear gray scale table
- *  @param   None
+ *  @param   stream: The command stream to append to.
  *  @returns None
  */
-static inline void ssd1322_set_linear_gray_scale_table(void)
+static inline void ssd1322_set_linear_gray_scale_table(ssd1322_stream_t *stream)
 {
-    ssd1322_write_command(SELECT_DEFAULT_LINEAR_GRAY_SCALE_TABLE);
+    ssd1322_stream_command(stream, SELECT_DEFAULT_LINEAR_GRAY_SCALE_TABLE);
+}
+
+/**
+ *  @brief   Uploads a custom gray scale table and enables it
+ *  @param   stream: The command stream to append to.
+ *  @param   table: The pulse widths of gray levels 1 to 15.
+ *  @returns None
+ */
+static inline void ssd1322_set_custom_gray_scale_table(ssd1322_stream_t *stream,
+                                                       const uint8_t *table)
+{
+    ssd1322_stream_command(stream, SET_GRAY_SCALE_TABLE);
+
+    for (uint8_t i = 0; i < GRAY_SCALE_TABLE_SIZE; i++)
+    {
+        ssd1322_stream_data(stream, table[i]);
+    }
+
+    ssd1322_stream_command(stream, ENABLE_GRAY_SCALE_TABLE);
 }
 
 /**
  * @brief   This function is used to lock the SSD1322 driver chip from accepting
  *          any command apart from the "command lock" command.
+ * @param   stream: The command stream to append to.
  * @param   command_lock: sets the SSD1322 to command lock or unlock.
  * @returns None
  */
-static inline void ssd1322_set_command_lock(uint8_t command_lock)
+static inline void ssd1322_set_command_lock(ssd1322_stream_t *stream,
+                                            uint8_t command_lock)
 {
-    ssd1322_write_command(SET_COMMAND_LOCK);
-    ssd1322_write_data(0x12 | command_lock);
+    ssd1322_stream_command(stream, SET_COMMAND_LOCK);
+    ssd1322_stream_data(stream, 0x12 | command_lock);
 }
 
 /**
- *  @brief   Initialize GPIOs connected to OLED display.
- *  @param   None.
- *  @returns None.
+ * @brief   This function keeps track of writes into GDDRAM. Every write
+ *          starts with a WRITE_RAM command, after which the GDDRAM no
+ *          longer matches the content-diff hashes.
+ *
+ * @param   command: A command about to be sent.
+ * @returns None
  */
-static inline void ssd1322_gpio_init(void)
-{
-    // Enable GPIOA clock
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
- 
-    // Configure PA0, PA1 and PA2 as output I/O.
-    GPIOA->MODER &=  ~(0x3UL << GPIO_MODER_MODER0_Pos) |
-                     ~(0x3UL << GPIO_MODER_MODER1_Pos) |
-                     ~(0x3UL << GPIO_MODER_MODER12_Pos);
-
-    GPIOA->MODER |=   (0x1UL << GPIO_MODER_MODER0_Pos) |
-                      (0x1UL << GPIO_MODER_MODER1_Pos) |
-                      (0x1UL << GPIO_MODER_MODER2_Pos);
-
-    // Configure PD4, PD12, PD13, PD14 & PD15 as very high speed I/O.
-    GPIOA->OSPEEDR |= (0x3UL << GPIO_OSPEEDR_OSPEED0_Pos) |
-                      (0x3UL << GPIO_OSPEEDR_OSPEED1_Pos) |
-                      (0x3UL << GPIO_OSPEEDR_OSPEED2_Pos);
-
-    // Configure PD4, PD12, PD13, PD14 & PD15 as push pull I/O.
-    GPIOA->OTYPER &= ~(0x1UL << GPIO_OTYPER_OT0_Pos) |
-                     ~(0x1UL << GPIO_OTYPER_OT1_Pos) |
-                     ~(0x1UL << GPIO_OTYPER_OT2_Pos);
-
-    // Disable pull up/pull down functionality on PD4, PD12, PD13, PD14 & PD15.
-    GPIOA->PUPDR &=  ~(0x3UL << GPIO_PUPDR_PUPD0_Pos) |
-                     ~(0x3UL << GPIO_PUPDR_PUPD1_Pos) |
-                     ~(0x3UL << GPIO_PUPDR_PUPD12_Pos);
-}
-
-// ****************************************************************************
-// * Module APIs
-// ****************************************************************************
-
-void ssd1322_write_data(uint8_t data)
-{
-    DATA_COMMAND_HIGH();
-    CHIP_SELECT_LOW();
-    // Write data
-    spi1_transmit(data);
-    CHIP_SELECT_HIGH();
-    DATA_COMMAND_LOW();
-}
-
-void ssd1322_write_data_buffer(uint8_t * fb, uint32_t buffer_size)
+static inline void ssd1322_track_write_ram(uint8_t command)
 {
-    // Send a buffer of data to the ssd1322 chip
-    DATA_COMMAND_HIGH();
-    CHIP_SELECT_LOW();
-    spi1_transmit_buffer(fb, BUFFER_SIZE);
-    DATA_COMMAND_HIGH();
-    CHIP_SELECT_HIGH();
+    if (command == WRITE_RAM)
+    {
+        g_diff_valid = 0;
+    }
 }
 
-void ssd1322_write_command(uint8_t command)
+/**
+ * @brief   This function selects a rectangular window of the SSD1322 GDDRAM
+ *          and enables it to be written to.
+ *
+ * @param   stream: The command stream to append to.
+ * @param   column_start: The initial column address.
+ * @param   column_end: The final column address.
+ * @param   row_start: The initial row address.
+ * @param   row_end: The final row address.
+ * @returns None
+ */
+static inline void ssd1322_set_window(ssd1322_stream_t *stream,
+                                      uint8_t column_start,
+                                      uint8_t column_end,
+                                      uint8_t row_start,
+                                      uint8_t row_end)
 {
-    DATA_COMMAND_LOW();
-    CHIP_SELECT_LOW();
-    // Write command
-    spi1_transmit(command);
-    CHIP_SELECT_HIGH();
-    DATA_COMMAND_HIGH();
+    ssd1322_stream_command(stream, SET_COLUMN_ADDRESS);
+    ssd1322_stream_data(stream, column_start);
+    ssd1322_stream_data(stream, column_end);
+    ssd1322_stream_command(stream, SET_ROW_ADDRESS);
+    ssd1322_stream_data(stream, row_start);
+    ssd1322_stream_data(stream, row_end);
+    ssd1322_stream_command(stream, WRITE_RAM);
 }
 
-void ssd1322_set_column_address(uint8_t column_start, uint8_t column_end)
+/**
+ * @brief   This function computes the number of frame buffer bytes covered
+ *          by a rectangle.
+ *
+ * @param   rect: The rectangle.
+ * @returns The number of bytes.
+ */
+static inline uint32_t ssd1322_rect_size(const ssd1322_rect_t *rect)
 {
-    ssd1322_write_command(SET_COLUMN_ADDRESS);
-    ssd1322_write_data(column_start);
-    ssd1322_write_data(column_end);
+    return (uint32_t) (rect->column_end - rect->column_start + 1) * 2U *
+           (uint32_t) (rect->row_end - rect->row_start + 1);
 }
 
-void ssd1322_set_row_address(uint8_t row_start, uint8_t row_end)
+/**
+ * @brief   This function grows a rectangle to cover another one.
+ *
+ * @param   rect: The rectangle to grow.
+ * @param   other: The rectangle to cover.
+ * @returns None
+ */
+static inline void ssd1322_rect_union(ssd1322_rect_t *rect,
+                                      const ssd1322_rect_t *other)
 {
-    ssd1322_write_command(SET_ROW_ADDRESS);
-    ssd1322_write_data(row_start);
-    ssd1322_write_data(row_end);
+    if (other->column_start < rect->column_start)
+    {
+        rect->column_start = other->column_start;
+    }
+    if (other->column_end > rect->column_end)
+    {
+        rect->column_end = other->column_end;
+    }
+    if (other->row_start < rect->row_start)
+    {
+        rect->row_start = other->row_start;
+    }
+    if (other->row_end > rect->row_end)
+    {
+        rect->row_end = other->row_end;
+    }
 }
 
-void ssd1322_write_ram_enable(void)
+/**
+ * @brief   This function checks if two rectangles overlap or share an edge,
+ *          in which case merging them never sends extra bytes.
+ *
+ * @param   a: The first rectangle.
+ * @param   b: The second rectangle.
+ * @returns 1 if the rectangles touch, 0 otherwise.
+ */
+static inline uint8_t ssd1322_rect_touch(const ssd1322_rect_t *a,
+                                         const ssd1322_rect_t *b)
 {
-    // Enable MCU to write into RAM
-    ssd1322_write_command(WRITE_RAM);
+    return (a->column_start <= b->column_end + 1) &&
+           (b->column_start <= a->column_end + 1) &&
+           (a->row_start <= b->row_end + 1) &&
+           (b->row_start <= a->row_end + 1);
 }
 
-void ssd1322_set_start_line(uint8_t start_line)
+/**
+ * @brief   This function records a region of frame buffer bytes as dirty.
+ *          Touching rectangles are merged. Once all rectangles are in use,
+ *          the region is merged into the rectangle which grows the least.
+ *
+ * @param   x_start: The first frame buffer byte column.
+ * @param   y_start: The first row.
+ * @param   x_end: The last frame buffer byte column.
+ * @param   y_end: The last row.
+ * @returns None
+ */
+static void ssd1322_mark_dirty(uint32_t x_start,
+                               uint32_t y_start,
+                               uint32_t x_end,
+                               uint32_t y_end)
 {
-    // Set vertical scroll by RAM
-    ssd1322_write_command(SET_DISPLAY_START_LINE);
-    // Default => 0x00
-    ssd1322_write_data(start_line);
-}
+    // Clip to the frame buffer
+    if ((x_start >= BUFFER_WIDTH) || (y_start >= BUFFER_HEIGHT) ||
+        (x_end < x_start) || (y_end < y_start))
+    {
+        return;
+    }
+    if (x_end >= BUFFER_WIDTH)
+    {
+        x_end = BUFFER_WIDTH - 1;
+    }
+    if (y_end >= BUFFER_HEIGHT)
+    {
+        y_end = BUFFER_HEIGHT - 1;
+    }
 
-void ssd1322_set_display_on_off(uint8_t display_on_off)
-{
-    ssd1322_write_command(DISPLAY_ON_OFF_MASK | display_on_off);
-}
+    // Each column address holds 2 bytes
+    ssd1322_rect_t rect =
+    {
+        .column_start = x_start >> 1,
+        .column_end   = x_end >> 1,
+        .row_start    = y_start,
+        .row_end      = y_end,
+    };
 
-void ssd1322_fill_ram(uint8_t data)
-{
-    ssd1322_set_column_address(0x00, 0x77);
-    ssd1322_set_row_address(0x00, 0x7F);
-    ssd1322_write_ram_enable();
+    // Merge into touching rectangles, a merge may make the result touch
+    // other rectangles so keep going until nothing touches
+    uint8_t i = 0;
 
-    for (uint8_t i = 0; i < GDDRAM_HEIGHT; i++)
+    while (i < g_dirty_count)
     {
-        for (uint8_t j = 0; j < GDDRAM_WIDTH; j++)
+        if (ssd1322_rect_touch(&rect, &g_dirty[i]))
+        {
+            ssd1322_rect_union(&rect, &g_dirty[i]);
+            g_dirty[i] = g_dirty[--g_dirty_count];
+            i = 0;
+        }
+        else
         {
-            ssd1322_write_data(data);
+            i++;
         }
     }
-}
 
-void ssd1322_initialize(void)
-{
-    // Initialize GPIO & SPI
-    ssd1322_gpio_init();
-    spi1_init(SPI_MODE_3);
+    if (g_dirty_count < SSD1322_DIRTY_RECTS)
+    {
+        g_dirty[g_dirty_count++] = rect;
+        return;
+    }
 
-    // SSD1322 Power on sequence
-    CHIP_RESET_LOW();
-    delay_ms(500);
-    CHIP_RESET_HIGH();
-    delay_ms(1000);
+    // Merge into the rectangle which grows the least
+    uint8_t best = 0;
+    uint32_t best_growth = UINT32_MAX;
 
-    // Initialization sequence
-    ssd1322_set_command_lock(COMMANDS_UNLOCK);
-    ssd1322_set_display_on_off(DISPLAY_OFF);
-    ssd1322_set_column_address(0x1C, 0x5B);
-    ssd1322_set_row_address(0x00, 0x3F);
-    // Set clock at 80 frames per second
-    ssd1322_set_display_clock(0xF1);
-    // Set multiplex ratio to 1/64
-    ssd1322_set_multiplex_ratio(0x3F);
-    ssd1322_set_display_offset(0x00);
-    ssd1322_set_start_line(0x00);
-    // Column address 0 mapped to SEG0
-    // Disable nibble remap
-    // Scan from COM[N-1] to C0M0
-    // Disable COM split between odd and even
-    // Enable dual COM line mode
-    ssd1322_set_remap_format(0x14);
-    // Disable GPIO pins input
-    ssd1322_set_gpio(0x00);
-    // Enable internal VDD regulator
-    ssd1322_set_function_selection(0x01);
-    // Enable external VSL
-    ssd1322_set_display_enhancement_a(ENABLE_EXTERNAL_VSL,
-                                      ENHANCED_LOW_GRAY_SCALE_QUALITY);
-    // Set segment output current
-    ssd1322_set_contrast_current(0x9F);
-    // Set scale factor of segment output current control
-    ssd1322_set_master_current(0x0F);
-    // Set default linear gray scale table
-    ssd1322_set_linear_gray_scale_table();
-    // Set phase 1 as 5 clocks and phase 2 as 14 clocks
-    ssd1322_set_phase_length(0xE2);
-    // Enhance driving scheme capability
-    ssd1322_set_display_enhancement_b(NORMAL_ENHANCEMENT);
-    // Set pre-charge voltage level as 0.60 * VCC
-    ssd1322_set_precharge_voltage(0x1F);
-    // Set second pre-charge period as 8 clocks
-    ssd1322_set_precharge_period(0x08);
-    // Set common pin deselect voltage as 0.86 * VCC
-    ssd1322_set_vcomh(0x07);
-    // Normal display mode - 0x02
-    ssd1322_set_display_mode(0x02);
-    ssd1322_set_partial_display(DISABLE_PARTIAL_DISPLAY, 0x00, 0x00);
-    ssd1322_set_display_on_off(DISPLAY_ON);
-}
+    for (i = 0; i < g_dirty_count; i++)
+    {
+        ssd1322_rect_t merged = g_dirty[i];
+        ssd1322_rect_union(&merged, &rect);
 
-void ssd1322_set_address(uint8_t x, uint8_t y)
-{
-    // There is a horizontal offset of 28 (pixels start from segment 112)
-    ssd1322_set_column_address((x + 0x1C), 0x5B);
-    ssd1322_set_row_address(y, 0x3F);
-    ssd1322_write_ram_enable();
-}
+        uint32_t growth = ssd1322_rect_size(&merged) -
+                          ssd1322_rect_size(&g_dirty[i]);
 
-void ssd1322_set_font(const font_t *font)
-{
-    // Set active font
-    g_active_font = font;
+        if (growth < best_growth)
+        {
+            best = i;
+            best_growth = growth;
+        }
+    }
+
+    ssd1322_rect_union(&g_dirty[best], &rect);
 }
 
-void ssd1322_put_pixel_fb(uint8_t *fb, uint8_t x_virtual, uint8_t y)
+/**
+ * @brief   This function sends a rectangle of a frame buffer through its
+ *          own address window.
+ *
+ * @param   fb: A pointer to the frame buffer.
+ * @param   rect: The rectangle to send.
+ * @returns The number of bytes sent.
+ */
+static uint32_t ssd1322_send_rect(uint8_t *fb, const ssd1322_rect_t *rect)
 {
-    // Convert x from a virtual address to a physical address
-    // This is done by dividing by 2
-    uint8_t x_physical = x_virtual >> 1;
+    ssd1322_stream_t stream;
 
-    // Check if the virtual address is odd or even.
-    // Two virtual addresses would provide the same physical address,
-    // so we'll need to determine which nibble to set.
-    // [0, 1] [2, 3] [4, 5]  ----> Virtual Address space
-    //    |      |      |
-    //    v      v      v
-    //    0      1      2    ----> Physical Address space
+    // Program the window of the rectangle
+    // This also waits for any previous transfer to complete
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_window(&stream,
+                       rect->column_start + DISPLAY_COLUMN_START,
+                       rect->column_end + DISPLAY_COLUMN_START,
+                       rect->row_start + g_page_row,
+                       rect->row_end + g_page_row);
+    ssd1322_stream_send(&stream);
 
-    if (x_virtual & 0x01)
+    // Send the rows of the rectangle with a single chip select assertion
+    uint8_t *row = fb + (rect->row_start * BUFFER_WIDTH) +
+                   (rect->column_start * 2U);
+    uint32_t width = (uint32_t) (rect->column_end - rect->column_start + 1) * 2U;
+
+    g_transport->select();
+
+    if (width == BUFFER_WIDTH)
     {
-        // If the virtual address is odd we want to set the right nibble
-        fb[(y * BUFFER_WIDTH) + x_physical] |= 0x0F;
+        // Full width rows are contiguous in the frame buffer
+        g_transport->send_data(row, ssd1322_rect_size(rect));
     }
     else
     {
-        // If the virtual address is even we want to set the left nibble
-        fb[(y * BUFFER_WIDTH) + x_physical] |= 0xF0;
+        for (uint8_t y = rect->row_start; y <= rect->row_end; y++)
+        {
+            g_transport->send_data(row, width);
+            row += BUFFER_WIDTH;
+        }
     }
+
+    g_transport->deselect();
+
+    return ssd1322_rect_size(rect);
 }
 
-void ssd1322_put_horizontal_line_fb(uint8_t *fb,
-                                    uint8_t x,
-                                    uint8_t y,
-                                    uint8_t length)
+/**
+ * @brief   This function fills a span of bytes. The bulk is written a word
+ *          at a time, four words per iteration so the stores can be merged
+ *          into multiple stores (STM / STRD). Spans of at least
+ *          SSD1322_FB_FILL_DMA_BYTES are written by DMA2 instead, unless
+ *          they are out of reach of the DMA (CCM RAM).
+ *
+ * @param   dst: The first byte of the span.
+ * @param   data: The byte written.
+ * @param   count: The number of bytes.
+ * @returns None
+ */
+static void ssd1322_fill_span(uint8_t *dst, uint8_t data, uint32_t count)
 {
-    for (uint8_t i = 0; i < length; i++)
+    uint32_t pattern = data * 0x01010101UL;
+
+    // Bytes up to the first word boundary
+    while ((count > 0) && ((uintptr_t) dst & 0x03))
     {
-        fb[(y * BUFFER_WIDTH) + x + i] = 0xFF;
+        *dst++ = data;
+        count--;
     }
-}
 
-void ssd1322_put_vertical_line_fb(uint8_t *fb,
-                                  uint8_t x,
-                                  uint8_t y,
-                                  uint8_t height,
-                                  uint8_t align)
-{
-    uint8_t i;
+    uint32_t *words = (uint32_t *) dst;
+    uint32_t word_count = count >> 2;
 
-    if (align == ALIGN_LEFT)
+#if SSD1322_FB_FILL_DMA_BYTES > 0
+    // Surfaces in CCM RAM are filled by the CPU, the DMA cannot reach them
+    if ((count >= SSD1322_FB_FILL_DMA_BYTES) &&
+        ((uintptr_t) words >= DMA2_M2M_MEMORY_START))
     {
-        for (i = 0; i < height; i++)
+        if (!g_fill_dma_ready)
         {
-            fb[((y + i) * BUFFER_WIDTH) + x] = 0xF0;
+            dma2_init();
+            g_fill_dma_ready = 1;
         }
+
+        // Callers draw into the span next, so wait for it
+        dma2_fill_words(words, pattern, word_count);
+        dma2_wait();
+
+        words += word_count;
+        word_count = 0;
     }
-    else if (align == ALIGN_RIGHT)
+#endif
+
+    while (word_count >= 4)
     {
-        for (i = 0; i < height; i++)
-        {
-            fb[((y + i) * BUFFER_WIDTH + x)] = 0x0F;
-        }
+        words[0] = pattern;
+        words[1] = pattern;
+        words[2] = pattern;
+        words[3] = pattern;
+        words += 4;
+        word_count -= 4;
+    }
+
+    while (word_count--)
+    {
+        *words++ = pattern;
+    }
+
+    // Bytes after the last whole word
+    dst = (uint8_t *) words;
+    count &= 0x03;
+
+    while (count--)
+    {
+        *dst++ = data;
     }
 }
 
-void ssd1322_put_rectangle_fb(uint8_t *fb,
-                              uint8_t x_1,
+/**
+ * @brief   This function copies a row of a resource to an odd pixel column,
+ *          shifting it right by one nibble with the carry. Full gray levels
+ *          are kept. The nibbles next to the row are left as they are, the
+ *          bytes in between are overwritten as on even columns. Where the
+ *          destination is word aligned, four bytes are shifted at a time.
+ *
+ * @param   dst: The frame buffer byte holding the first pixel.
+ * @param   src: The row of the resource.
+ * @param   columns: The number of bytes in the row (at least 1).
+ * @returns None
+ */
+static void ssd1322_blit_row_odd(uint8_t *dst, const uint8_t *src, uint32_t columns)
+{
+    uint32_t k = 1;
+
+    // The first pixel goes into the right nibble
+    dst[0] = (dst[0] & 0xF0) | (src[0] >> 4);
+
+    // Bytes up to the first word boundary
+    while ((k < columns) && ((uintptr_t) (dst + k) & 0x03))
+    {
+        dst[k] = (uint8_t) (src[k - 1] << 4) | (src[k] >> 4);
+        k++;
+    }
+
+    // Byte j of a word takes the right nibble of source byte j - 1 and the
+    // left nibble of source byte j
+    while ((k + 4) <= columns)
+    {
+        uint32_t word = ssd1322_read_word(src + k - 1);
+
+        *(uint32_t *) (dst + k) = ((word & 0x0F0F0F0FUL) << 4) |
+                                  ((word >> 12) & 0x000F0F0FUL) |
+                                  ((uint32_t) (src[k + 3] >> 4) << 24);
+        k += 4;
+    }
+
+    while (k < columns)
+    {
+        dst[k] = (uint8_t) (src[k - 1] << 4) | (src[k] >> 4);
+        k++;
+    }
+
+    // The last pixel spills into the left nibble of the next byte
+    dst[columns] = (dst[columns] & 0x0F) | (uint8_t) (src[columns - 1] << 4);
+}
+
+/**
+ * @brief   This function blends 8 resource pixels over 8 frame buffer
+ *          pixels. Each byte holds two pixels, so the pixels are split
+ *          into byte lanes (one per byte) for the SIMD instructions.
+ *
+ * @param   dst: The frame buffer pixels.
+ * @param   src: The resource pixels.
+ * @returns The blended pixels.
+ */
+static inline uint32_t ssd1322_blend_word(uint32_t dst, uint32_t src)
+{
+    uint32_t high;
+    uint32_t low;
+
+    switch (g_blend_mode)
+    {
+        case BLEND_OR:
+            return dst | src;
+
+        case BLEND_XOR:
+            return dst ^ src;
+
+        case BLEND_MAX:
+            // Compare the pixels in the upper half of every byte lane
+            high = ssd1322_lanes_max(dst & 0xF0F0F0F0UL, src & 0xF0F0F0F0UL);
+            low = ssd1322_lanes_max((dst << 4) & 0xF0F0F0F0UL,
+                                    (src << 4) & 0xF0F0F0F0UL);
+            return high | (low >> 4);
+
+        case BLEND_ADD:
+            high = ssd1322_lanes_add(dst & 0xF0F0F0F0UL, src & 0xF0F0F0F0UL);
+            low = ssd1322_lanes_add((dst << 4) & 0xF0F0F0F0UL,
+                                    (src << 4) & 0xF0F0F0F0UL);
+            return high | (low >> 4);
+
+        case BLEND_ALPHA:
+        {
+            uint32_t src_low = src & 0x0F0F0F0FUL;
+            uint32_t src_high = (src >> 4) & 0x0F0F0F0FUL;
+            uint32_t dst_low = dst & 0x0F0F0F0FUL;
+            uint32_t dst_high = (dst >> 4) & 0x0F0F0F0FUL;
+
+            // Weighted sums stay below 256, so lanes never carry into
+            // each other and a single multiply handles four lanes
+            low = ((src_low * g_blend_weight + dst_low * (16 - g_blend_weight) +
+                    0x08080808UL) >> 4) & 0x0F0F0F0FUL;
+            high = ((src_high * g_blend_weight + dst_high * (16 - g_blend_weight) +
+                     0x08080808UL) >> 4) & 0x0F0F0F0FUL;
+
+            // Lanes matching the key keep the frame buffer pixel
+            low = ssd1322_lanes_select_zero(src_low ^ g_blend_key, dst_low, low);
+            high = ssd1322_lanes_select_zero(src_high ^ g_blend_key, dst_high, high);
+
+            return low | (high << 4);
+        }
+
+        case BLEND_COPY:
+        default:
+            return src;
+    }
+}
+
+/**
+ * @brief   This function blends a span of resource bytes into a frame
+ *          buffer, a word at a time where the frame buffer is aligned.
+ *
+ * @param   dst: The first frame buffer byte.
+ * @param   src: The first resource byte.
+ * @param   count: The number of bytes.
+ * @returns None
+ */
+static void ssd1322_blend_span(uint8_t *dst, const uint8_t *src, uint32_t count)
+{
+    // Bytes up to the first word boundary
+    while ((count > 0) && ((uintptr_t) dst & 0x03))
+    {
+        *dst = (uint8_t) ssd1322_blend_word(*dst, *src++);
+        dst++;
+        count--;
+    }
+
+    while (count >= 4)
+    {
+        *(uint32_t *) dst = ssd1322_blend_word(*(uint32_t *) dst,
+                                               ssd1322_read_word(src));
+        dst += 4;
+        src += 4;
+        count -= 4;
+    }
+
+    while (count--)
+    {
+        *dst = (uint8_t) ssd1322_blend_word(*dst, *src++);
+        dst++;
+    }
+}
+
+/**
+ * @brief   This function draws a single pixel of a resource row, blended
+ *          like the rest of the row.
+ *
+ * @param   line: The frame buffer row.
+ * @param   x_virtual: The pixel column.
+ * @param   value: The gray level of the pixel.
+ * @returns None
+ */
+static inline void ssd1322_blit_pixel(uint8_t *line, uint32_t x_virtual, uint8_t value)
+{
+    uint8_t *dst = line + (x_virtual >> 1);
+    uint8_t mask = (x_virtual & 0x01) ? 0x0F : 0xF0;
+    uint8_t src = (x_virtual & 0x01) ? value : (uint8_t) (value << 4);
+    uint8_t blended = (uint8_t) ssd1322_blend_word(*dst, src);
+
+    *dst = (*dst & ~mask) | (blended & mask);
+}
+
+/**
+ * @brief   This function draws the pixels of a resource row which survived
+ *          clipping. A pixel left over at either end is drawn on its own,
+ *          the bytes in between go through the aligned or nibble shifting
+ *          paths, so there are no bounds checks per pixel.
+ *
+ * @param   line: The frame buffer row.
+ * @param   x_virtual: The pixel column of the first pixel drawn.
+ * @param   src: The resource row.
+ * @param   first: The first pixel of the resource row drawn.
+ * @param   width: The number of pixels drawn (at least 1).
+ * @returns None
+ */
+static void ssd1322_blit_row(uint8_t *line,
+                             uint32_t x_virtual,
+                             const uint8_t *src,
+                             uint32_t first,
+                             uint32_t width)
+{
+    // A first pixel in the right nibble of a resource byte
+    if (first & 0x01)
+    {
+        ssd1322_blit_pixel(line, x_virtual, src[first >> 1] & 0x0F);
+        x_virtual++;
+        first++;
+        width--;
+    }
+
+    src += first >> 1;
+
+    // A last pixel in the left nibble of a resource byte
+    if (width & 0x01)
+    {
+        ssd1322_blit_pixel(line, x_virtual + width - 1, src[width >> 1] >> 4);
+        width--;
+    }
+
+    uint32_t columns = width >> 1;
+    uint8_t *row = line + (x_virtual >> 1);
+
+    if (columns == 0)
+    {
+        return;
+    }
+
+    if (g_blend_mode != BLEND_COPY)
+    {
+        if (!(x_virtual & 0x01))
+        {
+            ssd1322_blend_span(row, src, columns);
+        }
+        else
+        {
+            // Shift the row by a nibble, then blend it over the frame
+            // buffer and give the nibbles next to it back. Surfaces may be
+            // wider than the shift buffer, so this is done in pieces.
+            while (columns > 0)
+            {
+                uint32_t count = (columns < (BUFFER_WIDTH - 1)) ? columns : (BUFFER_WIDTH - 1);
+                uint8_t before = row[0];
+                uint8_t after = row[count];
+
+                g_blend_row[0] = 0x00;
+                g_blend_row[count] = 0x00;
+                ssd1322_blit_row_odd(g_blend_row, src, count);
+                ssd1322_blend_span(row, g_blend_row, count + 1);
+
+                row[0] = (before & 0xF0) | (row[0] & 0x0F);
+                row[count] = (row[count] & 0xF0) | (after & 0x0F);
+
+                row += count;
+                src += count;
+                columns -= count;
+            }
+        }
+    }
+    // Check if the virtual address is even
+    else if (!(x_virtual & 0x01))
+    {
+        // Display incoming pixels at the current physical x coordinate
+        memcpy(row, src, columns);
+    }
+    else
+    {
+        // If the virtual address is odd, the row is shifted by a nibble
+        ssd1322_blit_row_odd(row, src, columns);
+    }
+}
+
+/**
+ * @brief   This function records a region of a surface as dirty, if the
+ *          surface is part of a display frame buffer.
+ *
+ * @param   surface: The surface drawn into.
+ * @param   x_start: The first byte column.
+ * @param   y_start: The first row.
+ * @param   x_end: The last byte column.
+ * @param   y_end: The last row.
+ * @returns None
+ */
+static inline void ssd1322_surface_mark(const ssd1322_surface_t *surface,
+                                        uint32_t x_start,
+                                        uint32_t y_start,
+                                        uint32_t x_end,
+                                        uint32_t y_end)
+{
+    if (surface->track_dirty)
+    {
+        ssd1322_mark_dirty(surface->fb_column + x_start, surface->fb_row + y_start,
+                           surface->fb_column + x_end, surface->fb_row + y_end);
+    }
+}
+
+/**
+ * @brief   This function finds a row of a surface.
+ *
+ * @param   surface: The surface.
+ * @param   y: The row.
+ * @returns A pointer to the first byte of the row.
+ */
+static inline uint8_t *ssd1322_surface_line(const ssd1322_surface_t *surface, uint32_t y)
+{
+    return surface->rows[y] + surface->x_byte;
+}
+
+/**
+ * @brief   This function binds the frame buffer surface to a frame buffer,
+ *          rebuilding its row table when the frame buffer changes.
+ *
+ * @param   fb: A pointer to the frame buffer.
+ * @returns The frame buffer surface.
+ */
+static ssd1322_surface_t *ssd1322_fb_surface(uint8_t *fb)
+{
+    if (g_fb_rows[0] != fb)
+    {
+        for (uint8_t i = 0; i < BUFFER_HEIGHT; i++)
+        {
+            g_fb_rows[i] = fb + (i * BUFFER_WIDTH);
+        }
+    }
+
+    return &g_fb_surface;
+}
+
+/**
+ * @brief   This function draws rows of 4-bit pixels into a surface, trimmed
+ *          to its clip rectangle up front.
+ *
+ * @param   surface: The surface drawn into.
+ * @param   x_virtual: The x coordinate of the first pixel.
+ * @param   y: The y coordinate of the first row.
+ * @param   rows: The number of rows.
+ * @param   width: The number of pixels in a row.
+ * @param   src: The first source row.
+ * @param   src_stride: The bytes between source rows.
+ * @returns None
+ */
+static void ssd1322_surface_blit(ssd1322_surface_t *surface,
+                                 int32_t x_virtual,
+                                 int32_t y,
+                                 uint32_t rows,
+                                 uint32_t width,
+                                 const uint8_t *src,
+                                 uint32_t src_stride)
+{
+    int32_t x_start = x_virtual;
+    int32_t x_end = x_virtual + (int32_t) width - 1;
+    int32_t y_start = y;
+    int32_t y_end = y + (int32_t) rows - 1;
+
+    x_start = (x_start < surface->clip_x_start) ? surface->clip_x_start : x_start;
+    x_end = (x_end > surface->clip_x_end) ? surface->clip_x_end : x_end;
+    y_start = (y_start < surface->clip_y_start) ? surface->clip_y_start : y_start;
+    y_end = (y_end > surface->clip_y_end) ? surface->clip_y_end : y_end;
+
+    if ((x_start > x_end) || (y_start > y_end))
+    {
+        // Exit if the pixels are outside of the clip rectangle
+        return;
+    }
+
+    ssd1322_surface_mark(surface, x_start >> 1, y_start, x_end >> 1, y_end);
+
+    // Skip the rows and pixels which were clipped away
+    uint32_t first = x_start - x_virtual;
+
+    width = x_end - x_start + 1;
+    src += (uint32_t) (y_start - y) * src_stride;
+
+    for (int32_t i = y_start; i <= y_end; i++)
+    {
+        ssd1322_blit_row(ssd1322_surface_line(surface, i), x_start, src, first, width);
+        src += src_stride;
+    }
+}
+
+/**
+ * @brief   This function selects the GDDRAM rows a whole frame is written
+ *          into, the hidden page when page flipping is enabled, otherwise
+ *          the page being displayed.
+ *
+ * @param   None
+ * @returns The first GDDRAM row of the page.
+ */
+static inline uint8_t ssd1322_frame_page_row(void)
+{
+    return g_page_flip ? (g_page_row ^ BUFFER_HEIGHT) : g_page_row;
+}
+
+/**
+ * @brief   This function selects a whole page of the GDDRAM for writing.
+ *
+ * @param   page_row: The first GDDRAM row of the page.
+ * @returns None
+ */
+static void ssd1322_set_page_address(uint8_t page_row)
+{
+    ssd1322_stream_t stream;
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_window(&stream, DISPLAY_COLUMN_START,
+                       DISPLAY_COLUMN_END,
+                       page_row, page_row + BUFFER_HEIGHT - 1);
+    ssd1322_stream_send(&stream);
+}
+
+/**
+ * @brief   This function uploads one frame buffer row into a GDDRAM row.
+ *
+ * @param   gddram_row: The GDDRAM row (0 - 127).
+ * @param   row: The BUFFER_WIDTH bytes of the row.
+ * @returns None
+ */
+static void ssd1322_write_row(uint8_t gddram_row, const uint8_t *row)
+{
+    ssd1322_stream_t stream;
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_window(&stream, DISPLAY_COLUMN_START,
+                       DISPLAY_COLUMN_END,
+                       gddram_row, gddram_row);
+    ssd1322_stream_send(&stream);
+
+    g_transport->select();
+    g_transport->send_data(row, BUFFER_WIDTH);
+    g_transport->deselect();
+}
+
+/**
+ * @brief   This function opens a window on the page being displayed and
+ *          keeps chip select asserted for the data which follows.
+ *
+ * @param   column_start: The first column address relative to the display.
+ * @param   column_end: The last column address relative to the display.
+ * @param   row_start: The first row.
+ * @param   row_end: The last row.
+ * @returns None
+ */
+static void ssd1322_open_window(uint8_t column_start,
+                                uint8_t column_end,
+                                uint8_t row_start,
+                                uint8_t row_end)
+{
+    ssd1322_stream_t stream;
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_window(&stream,
+                       column_start + DISPLAY_COLUMN_START,
+                       column_end + DISPLAY_COLUMN_START,
+                       row_start + g_page_row,
+                       row_end + g_page_row);
+    ssd1322_stream_send(&stream);
+
+    g_transport->select();
+}
+
+/**
+ * @brief   This function fills a window on the page being displayed with
+ *          the same two bytes per column address.
+ *
+ * @param   column_start: The first column address relative to the display.
+ * @param   column_end: The last column address relative to the display.
+ * @param   row_start: The first row.
+ * @param   row_end: The last row.
+ * @param   left: The left byte of each column address.
+ * @param   right: The right byte of each column address.
+ * @returns None
+ */
+static void ssd1322_fill_window(uint8_t column_start,
+                                uint8_t column_end,
+                                uint8_t row_start,
+                                uint8_t row_end,
+                                uint8_t left,
+                                uint8_t right)
+{
+    uint32_t count = (uint32_t) (column_end - column_start + 1) *
+                     (uint32_t) (row_end - row_start + 1);
+
+    ssd1322_open_window(column_start, column_end, row_start, row_end);
+
+    if (left == right)
+    {
+        g_transport->send_data_repeat(left, count * 2U);
+    }
+    else
+    {
+        // Fill the line buffer with pairs once and send it in as few
+        // pieces as possible, every piece holds the same bytes
+        uint32_t pairs = (count < (BUFFER_WIDTH / 2U)) ? count : (BUFFER_WIDTH / 2U);
+
+        for (uint32_t i = 0; i < pairs; i++)
+        {
+            g_line[i * 2U] = left;
+            g_line[(i * 2U) + 1U] = right;
+        }
+
+        while (count > 0)
+        {
+            uint32_t piece = (count < pairs) ? count : pairs;
+
+            g_transport->send_data(g_line, piece * 2U);
+            count -= piece;
+        }
+    }
+
+    g_transport->deselect();
+}
+
+/**
+ *  @brief   Waits for any asynchronous transfer to complete, then shows the
+ *           page it uploaded if a flip is pending. The SPI bus may only be
+ *           used from thread context, so the flip is never sent by the
+ *           transfer complete handler.
+ *  @param   None.
+ *  @returns None.
+ */
+static void ssd1322_wait_transfer(void)
+{
+    while (g_fb_transfer_busy);
+
+    if (g_flip_pending)
+    {
+        // Cleared first, sending the command waits for transfers as well
+        g_flip_pending = 0;
+        // Show the page which has just been uploaded
+        ssd1322_set_start_line(g_page_row ^ BUFFER_HEIGHT);
+        g_page_row ^= BUFFER_HEIGHT;
+    }
+}
+
+/**
+ *  @brief   Releases the SSD1322 once an asynchronous transfer completes.
+ *           This is called from interrupt context.
+ *  @param   None.
+ *  @returns None.
+ */
+static void ssd1322_transfer_complete(void)
+{
+    g_transport->deselect();
+
+    g_fb_transfer_busy = 0;
+
+    if (g_fb_transfer_callback != NULL)
+    {
+        g_fb_transfer_callback();
+    }
+}
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+void ssd1322_set_transport(const ssd1322_transport_t *transport)
+{
+    // Wait for any asynchronous transfer to complete
+    ssd1322_wait_transfer();
+
+    g_transport = transport;
+}
+
+void ssd1322_write_data(uint8_t data)
+{
+    // Wait for any asynchronous transfer to complete
+    ssd1322_wait_transfer();
+
+    g_transport->select();
+    // Write data
+    g_transport->send_data(&data, 1);
+    g_transport->deselect();
+}
+
+void ssd1322_write_data_buffer(uint8_t * fb, uint32_t buffer_size)
+{
+    // Wait for any asynchronous transfer to complete
+    ssd1322_wait_transfer();
+
+    // Send a buffer of data to the ssd1322 chip
+    g_transport->select();
+    g_transport->send_data(fb, buffer_size);
+    g_transport->deselect();
+}
+
+void ssd1322_write_command(uint8_t command)
+{
+    // Wait for any asynchronous transfer to complete
+    ssd1322_wait_transfer();
+
+    ssd1322_track_write_ram(command);
+
+    g_transport->select();
+    // Write command
+    g_transport->send_command(&command, 1);
+    g_transport->deselect();
+}
+
+void ssd1322_stream_begin(ssd1322_stream_t *stream)
+{
+    stream->length = 0;
+    // Bits are set and cleared one at a time, start from known values
+    memset(stream->command_mask, 0, sizeof(stream->command_mask));
+}
+
+void ssd1322_stream_command(ssd1322_stream_t *stream, uint8_t command)
+{
+    // Send what has been collected so far if the stream is full
+    if (stream->length == SSD1322_STREAM_SIZE)
+    {
+        ssd1322_stream_send(stream);
+    }
+
+    ssd1322_track_write_ram(command);
+
+    // Mark the byte as a command
+    stream->command_mask[stream->length >> 3] |= (1U << (stream->length & 0x07));
+    stream->bytes[stream->length++] = command;
+}
+
+void ssd1322_stream_data(ssd1322_stream_t *stream, uint8_t data)
+{
+    // Send what has been collected so far if the stream is full
+    if (stream->length == SSD1322_STREAM_SIZE)
+    {
+        ssd1322_stream_send(stream);
+    }
+
+    // Mark the byte as data
+    stream->command_mask[stream->length >> 3] &= ~(1U << (stream->length & 0x07));
+    stream->bytes[stream->length++] = data;
+}
+
+void ssd1322_stream_send(ssd1322_stream_t *stream)
+{
+    if (stream->length == 0)
+    {
+        return;
+    }
+
+    // Wait for any asynchronous transfer to complete
+    ssd1322_wait_transfer();
+
+    g_transport->select();
+
+    // Send runs of commands and runs of data, so the transport only
+    // changes the data / command line at command / data boundaries.
+    uint8_t start = 0;
+
+    while (start < stream->length)
+    {
+        uint8_t command = (stream->command_mask[start >> 3] >> (start & 0x07)) & 0x01;
+        uint8_t end = start + 1;
+
+        while ((end < stream->length) &&
+               (((stream->command_mask[end >> 3] >> (end & 0x07)) & 0x01) == command))
+        {
+            end++;
+        }
+
+        if (command)
+        {
+            g_transport->send_command(&stream->bytes[start], end - start);
+        }
+        else
+        {
+            g_transport->send_data(&stream->bytes[start], end - start);
+        }
+
+        start = end;
+    }
+
+    g_transport->deselect();
+
+    stream->length = 0;
+}
+
+void ssd1322_set_column_address(uint8_t column_start, uint8_t column_end)
+{
+    ssd1322_stream_t stream;
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_stream_command(&stream, SET_COLUMN_ADDRESS);
+    ssd1322_stream_data(&stream, column_start);
+    ssd1322_stream_data(&stream, column_end);
+    ssd1322_stream_send(&stream);
+}
+
+void ssd1322_set_row_address(uint8_t row_start, uint8_t row_end)
+{
+    ssd1322_stream_t stream;
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_stream_command(&stream, SET_ROW_ADDRESS);
+    ssd1322_stream_data(&stream, row_start);
+    ssd1322_stream_data(&stream, row_end);
+    ssd1322_stream_send(&stream);
+}
+
+void ssd1322_write_ram_enable(void)
+{
+    // Enable MCU to write into RAM
+    ssd1322_write_command(WRITE_RAM);
+}
+
+void ssd1322_set_start_line(uint8_t start_line)
+{
+    ssd1322_stream_t stream;
+
+    ssd1322_stream_begin(&stream);
+    // Set vertical scroll by RAM
+    ssd1322_stream_command(&stream, SET_DISPLAY_START_LINE);
+    // Default => 0x00
+    ssd1322_stream_data(&stream, start_line);
+    ssd1322_stream_send(&stream);
+}
+
+void ssd1322_set_display_on_off(uint8_t display_on_off)
+{
+    ssd1322_write_command(DISPLAY_ON_OFF_MASK | display_on_off);
+}
+
+void ssd1322_set_refresh_profile(const ssd1322_refresh_profile_t *profile)
+{
+    ssd1322_stream_t stream;
+
+    g_refresh_profile = *profile;
+
+    if (g_refresh_profile.multiplex_rows < MULTIPLEX_ROWS_MIN)
+    {
+        g_refresh_profile.multiplex_rows = MULTIPLEX_ROWS_MIN;
+    }
+    else if (g_refresh_profile.multiplex_rows > MULTIPLEX_ROWS_MAX)
+    {
+        g_refresh_profile.multiplex_rows = MULTIPLEX_ROWS_MAX;
+    }
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_display_clock(&stream, g_refresh_profile.display_clock);
+    ssd1322_set_phase_length(&stream, g_refresh_profile.phase_length);
+    ssd1322_set_multiplex_ratio(&stream, g_refresh_profile.multiplex_rows - 1);
+    ssd1322_set_partial_display(&stream,
+                                g_refresh_profile.partial ? ENABLE_PARTIAL_DISPLAY :
+                                                            DISABLE_PARTIAL_DISPLAY,
+                                g_refresh_profile.partial_start,
+                                g_refresh_profile.partial_end);
+    ssd1322_stream_send(&stream);
+}
+
+const ssd1322_refresh_profile_t * ssd1322_get_refresh_profile(void)
+{
+    return &g_refresh_profile;
+}
+
+void ssd1322_estimate_refresh(const ssd1322_refresh_profile_t *profile,
+                              ssd1322_refresh_info_t *info)
+{
+    if (profile == NULL)
+    {
+        profile = &g_refresh_profile;
+    }
+
+    // Oscillator frequency, taken as linear between the nominal limits
+    uint32_t osc_hz = SSD1322_OSC_MIN_HZ +
+                      ((SSD1322_OSC_MAX_HZ - SSD1322_OSC_MIN_HZ) *
+                       (uint32_t) (profile->display_clock >> 4)) / 15U;
+
+    // Divide ratio D, settings above 1024 are invalid
+    uint8_t divide_log2 = profile->display_clock & 0x0F;
+    uint32_t divide = 1UL << ((divide_log2 > 10) ? 10 : divide_log2);
+
+    // Display clocks of a row K: phase 1, phase 2 and current drive
+    uint32_t row_dclks = 2U * (profile->phase_length & 0x0F) + 1U +
+                         (profile->phase_length >> 4) +
+                         SSD1322_CURRENT_DRIVE_DCLKS;
+
+    uint32_t rows = profile->multiplex_rows;
+
+    if (rows < MULTIPLEX_ROWS_MIN)
+    {
+        rows = MULTIPLEX_ROWS_MIN;
+    }
+
+    uint64_t row_osc_cycles = (uint64_t) divide * row_dclks;
+
+    info->row_time_ns = (uint32_t) ((row_osc_cycles * 1000000000ULL) / osc_hz);
+    info->frame_rate_centihz = (uint32_t) (((uint64_t) osc_hz * 100U) /
+                                           (row_osc_cycles * rows));
+}
+
+void ssd1322_select_display_mode(uint8_t display_mode)
+{
+    ssd1322_write_command(SET_DISPLAY_MODE_MASK | (display_mode & 0x03));
+
+    g_display_mode = display_mode & 0x03;
+}
+
+uint8_t ssd1322_get_display_mode(void)
+{
+    return g_display_mode;
+}
+
+void ssd1322_set_contrast(uint8_t contrast_current)
+{
+    ssd1322_stream_t stream;
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_contrast_current(&stream, contrast_current);
+    ssd1322_stream_send(&stream);
+
+    g_contrast_current = contrast_current;
+}
+
+uint8_t ssd1322_get_contrast(void)
+{
+    return g_contrast_current;
+}
+
+void ssd1322_set_master_brightness(uint8_t master_current)
+{
+    ssd1322_stream_t stream;
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_master_current(&stream, master_current & 0x0F);
+    ssd1322_stream_send(&stream);
+
+    g_master_current = master_current & 0x0F;
+}
+
+uint8_t ssd1322_get_master_brightness(void)
+{
+    return g_master_current;
+}
+
+void ssd1322_set_gray_scale_table(const uint8_t *table)
+{
+    ssd1322_stream_t stream;
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_custom_gray_scale_table(&stream, table);
+    ssd1322_stream_send(&stream);
+
+    memcpy(g_gray_table, table, GRAY_SCALE_TABLE_SIZE);
+    g_gray_table_custom = 1;
+}
+
+void ssd1322_select_default_gray_scale_table(void)
+{
+    ssd1322_write_command(SELECT_DEFAULT_LINEAR_GRAY_SCALE_TABLE);
+
+    g_gray_table_custom = 0;
+}
+
+uint8_t ssd1322_get_gray_scale_table(uint8_t *table)
+{
+    memcpy(table, g_gray_table_custom ? g_gray_table : ssd1322_gray_table_linear,
+           GRAY_SCALE_TABLE_SIZE);
+
+    return g_gray_table_custom;
+}
+
+uint32_t ssd1322_fill_ram(uint8_t data)
+{
+    return ssd1322_fill_ram_window(0x00, GDDRAM_COLUMN_END,
+                                   0x00, GDDRAM_ROW_END, data);
+}
+
+uint32_t ssd1322_fill_ram_window(uint8_t column_start,
+                                 uint8_t column_end,
+                                 uint8_t row_start,
+                                 uint8_t row_end,
+                                 uint8_t data)
+{
+    ssd1322_stream_t stream;
+    uint32_t start = ssd1322_timestamp();
+
+    // Each column address holds 4 pixels (2 bytes)
+    uint32_t count = (uint32_t) (column_end - column_start + 1) * 2U *
+                     (uint32_t) (row_end - row_start + 1);
+
+    // Select the window to be filled
+    // This also waits for any previous transfer to complete
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_window(&stream, column_start, column_end, row_start, row_end);
+    ssd1322_stream_send(&stream);
+
+    // Stream the fill byte with a single chip select assertion
+    g_transport->select();
+    g_transport->send_data_repeat(data, count);
+    g_transport->deselect();
+
+    return ssd1322_timestamp() - start;
+}
+
+uint8_t ssd1322_read_ram_window(uint8_t column_start,
+                                uint8_t column_end,
+                                uint8_t row_start,
+                                uint8_t row_end,
+                                uint8_t * buffer)
+{
+    ssd1322_stream_t stream;
+    uint8_t dummy;
+
+    if (g_transport->read_data == NULL)
+    {
+        // Exit if the bus cannot read from the SSD1322
+        return 0;
+    }
+
+    // Each column address holds 4 pixels (2 bytes)
+    uint32_t count = (uint32_t) (column_end - column_start + 1) * 2U *
+                     (uint32_t) (row_end - row_start + 1);
+
+    // Select the window to be read
+    ssd1322_stream_begin(&stream);
+    ssd1322_stream_command(&stream, SET_COLUMN_ADDRESS);
+    ssd1322_stream_data(&stream, column_start);
+    ssd1322_stream_data(&stream, column_end);
+    ssd1322_stream_command(&stream, SET_ROW_ADDRESS);
+    ssd1322_stream_data(&stream, row_start);
+    ssd1322_stream_data(&stream, row_end);
+    ssd1322_stream_send(&stream);
+
+    uint8_t command = READ_RAM;
+
+    g_transport->select();
+    g_transport->send_command(&command, 1);
+    // The first read after READ_RAM returns dummy data
+    g_transport->read_data(&dummy, 1);
+    g_transport->read_data(buffer, count);
+    g_transport->deselect();
+
+    return 1;
+}
+
+void ssd1322_initialize(void)
+{
+    // Let an asynchronous transfer finish before the bus is set up again.
+    // The panel is reset, so a pending page flip is dropped.
+    while (g_fb_transfer_busy);
+    g_flip_pending = 0;
+
+    // Initialize GPIO & bus
+    g_transport->init();
+#if !SSD1322_HOST_BUILD
+    crc_init();
+#endif
+    g_diff_valid = 0;
+    g_page_row = 0;
+
+    // SSD1322 Power on sequence
+    // The memory sink of a host build is ready straight away
+    g_transport->set_reset(0);
+#if !SSD1322_HOST_BUILD
+    delay_ms(500);
+#endif
+    g_transport->set_reset(1);
+#if !SSD1322_HOST_BUILD
+    delay_ms(1000);
+#endif
+
+    ssd1322_stream_t stream;
+
+    // Initialization sequence
+    // The whole sequence is sent with a single chip select assertion
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_command_lock(&stream, COMMANDS_UNLOCK);
+    ssd1322_stream_command(&stream, DISPLAY_ON_OFF_MASK | DISPLAY_OFF);
+    ssd1322_stream_command(&stream, SET_COLUMN_ADDRESS);
+    ssd1322_stream_data(&stream, DISPLAY_COLUMN_START);
+    ssd1322_stream_data(&stream, DISPLAY_COLUMN_END);
+    ssd1322_stream_command(&stream, SET_ROW_ADDRESS);
+    ssd1322_stream_data(&stream, 0x00);
+    ssd1322_stream_data(&stream, 0x3F);
+    // Set clock at 80 frames per second
+    g_refresh_profile = ssd1322_profile_default;
+    ssd1322_set_display_clock(&stream, g_refresh_profile.display_clock);
+    // Set multiplex ratio to 1/64
+    ssd1322_set_multiplex_ratio(&stream, g_refresh_profile.multiplex_rows - 1);
+    ssd1322_set_display_offset(&stream, 0x00);
+    ssd1322_stream_command(&stream, SET_DISPLAY_START_LINE);
+    ssd1322_stream_data(&stream, 0x00);
+    // Re-map format of the selected orientation, by default:
+    // Column address 0 mapped to SEG0
+    // Enable nibble remap (first pixel in the upper nibble)
+    // Scan from COM[N-1] to C0M0
+    // Disable COM split between odd and even
+    // Enable dual COM line mode
+    ssd1322_set_remap_format(&stream, g_remap_format);
+    // Disable GPIO pins input
+    ssd1322_set_gpio(&stream, 0x00);
+    // Enable internal VDD regulator
+    ssd1322_set_function_selection(&stream, 0x01);
+    // Enable external VSL
+    ssd1322_set_display_enhancement_a(&stream, ENABLE_EXTERNAL_VSL,
+                                      ENHANCED_LOW_GRAY_SCALE_QUALITY);
+    // Set segment output current
+    g_contrast_current = DEFAULT_CONTRAST_CURRENT;
+    ssd1322_set_contrast_current(&stream, g_contrast_current);
+    // Set scale factor of segment output current control
+    g_master_current = DEFAULT_MASTER_CURRENT;
+    ssd1322_set_master_current(&stream, g_master_current);
+    // Set default linear gray scale table
+    g_gray_table_custom = 0;
+    ssd1322_set_linear_gray_scale_table(&stream);
+    // Set phase 1 as 5 clocks and phase 2 as 14 clocks
+    ssd1322_set_phase_length(&stream, g_refresh_profile.phase_length);
+    // Enhance driving scheme capability
+    ssd1322_set_display_enhancement_b(&stream, NORMAL_ENHANCEMENT);
+    // Set pre-charge voltage level as 0.60 * VCC
+    ssd1322_set_precharge_voltage(&stream, 0x1F);
+    // Set second pre-charge period as 8 clocks
+    ssd1322_set_precharge_period(&stream, 0x08);
+    // Set common pin deselect voltage as 0.86 * VCC
+    ssd1322_set_vcomh(&stream, 0x07);
+    // Normal display mode
+    g_display_mode = DISPLAY_MODE_NORMAL;
+    ssd1322_set_display_mode(&stream, g_display_mode);
+    ssd1322_set_partial_display(&stream, DISABLE_PARTIAL_DISPLAY, 0x00, 0x00);
+    ssd1322_stream_command(&stream, DISPLAY_ON_OFF_MASK | DISPLAY_ON);
+    ssd1322_stream_send(&stream);
+}
+
+void ssd1322_set_address(uint8_t x, uint8_t y)
+{
+    ssd1322_stream_t stream;
+
+    // There is a horizontal offset of 28 (pixels start from segment 112)
+    ssd1322_stream_begin(&stream);
+    // Rows are relative to the page being displayed
+    ssd1322_set_window(&stream, (x + DISPLAY_COLUMN_START),
+                       DISPLAY_COLUMN_END,
+                       y + g_page_row, g_page_row + BUFFER_HEIGHT - 1);
+    ssd1322_stream_send(&stream);
+}
+
+void ssd1322_set_font(const font_t *font)
+{
+    // Set active font
+    g_active_font = font;
+}
+
+const font_t *ssd1322_get_font(void)
+{
+    return g_active_font;
+}
+
+void ssd1322_set_clip_fb(uint8_t x_virtual_start,
+                         uint8_t y_start,
+                         uint8_t x_virtual_end,
+                         uint8_t y_end)
+{
+    ssd1322_surface_set_clip(&g_fb_surface, x_virtual_start, y_start,
+                             x_virtual_end, y_end);
+}
+
+void ssd1322_reset_clip_fb(void)
+{
+    ssd1322_surface_reset_clip(&g_fb_surface);
+}
+
+void ssd1322_set_blend_mode(uint8_t blend_mode)
+{
+    g_blend_mode = (blend_mode > BLEND_ALPHA) ? BLEND_COPY : blend_mode;
+}
+
+void ssd1322_set_blend_alpha(uint8_t alpha, uint8_t key)
+{
+    alpha = (alpha > 0x0F) ? 0x0F : alpha;
+
+    // Spread 0 - 15 over 0 - 16, so 15 is fully opaque
+    g_blend_weight = alpha + (alpha >> 3);
+    g_blend_key = (key & 0x0F) * 0x01010101UL;
+}
+
+void ssd1322_surface_init(ssd1322_surface_t *surface,
+                          uint8_t *pixels,
+                          uint8_t **row_table,
+                          uint16_t width,
+                          uint8_t height,
+                          uint16_t stride)
+{
+    for (uint8_t i = 0; i < height; i++)
+    {
+        row_table[i] = pixels + ((uint32_t) i * stride);
+    }
+
+    surface->rows = row_table;
+    surface->x_byte = 0;
+    // Rows are whole bytes
+    surface->width = width & ~0x01;
+    surface->height = height;
+    surface->stride = stride;
+    surface->bpp = SURFACE_BPP;
+    // Off-screen surfaces are not part of a display frame buffer
+    surface->track_dirty = 0;
+    surface->fb_column = 0;
+    surface->fb_row = 0;
+
+    ssd1322_surface_reset_clip(surface);
+}
+
+void ssd1322_surface_init_fb(ssd1322_surface_t *surface,
+                             uint8_t *fb,
+                             uint8_t **row_table)
+{
+    ssd1322_surface_init(surface, fb, row_table, DISPLAY_WIDTH, BUFFER_HEIGHT, BUFFER_WIDTH);
+
+    // Drawing is recorded as dirty for the next partial flush
+    surface->track_dirty = 1;
+}
+
+void ssd1322_surface_view(ssd1322_surface_t *view,
+                          const ssd1322_surface_t *parent,
+                          uint16_t x_virtual,
+                          uint8_t y,
+                          uint16_t width,
+                          uint8_t height)
+{
+    // Views start on a whole byte
+    x_virtual &= ~0x01;
+
+    // Keep the view inside of its parent
+    x_virtual = (x_virtual > parent->width) ? parent->width : x_virtual;
+    y = (y > parent->height) ? parent->height : y;
+    width = ((uint32_t) x_virtual + width > parent->width) ? (parent->width - x_virtual) : width;
+    height = ((uint32_t) y + height > parent->height) ? (parent->height - y) : height;
+
+    // The parent's row table is shared, starting at the first row of the view
+    view->rows = parent->rows + y;
+    view->x_byte = parent->x_byte + (x_virtual >> 1);
+    view->width = width & ~0x01;
+    view->height = height;
+    view->stride = parent->stride;
+    view->bpp = parent->bpp;
+    view->track_dirty = parent->track_dirty;
+    view->fb_column = parent->fb_column + (x_virtual >> 1);
+    view->fb_row = parent->fb_row + y;
+
+    ssd1322_surface_reset_clip(view);
+}
+
+void ssd1322_surface_set_clip(ssd1322_surface_t *surface,
+                              uint16_t x_virtual_start,
+                              uint8_t y_start,
+                              uint16_t x_virtual_end,
+                              uint8_t y_end)
+{
+    surface->clip_x_start = x_virtual_start;
+    surface->clip_x_end = (x_virtual_end >= surface->width) ?
+                          ((int16_t) surface->width - 1) : x_virtual_end;
+    surface->clip_y_start = y_start;
+    surface->clip_y_end = (y_end >= surface->height) ?
+                          ((int16_t) surface->height - 1) : y_end;
+}
+
+void ssd1322_surface_reset_clip(ssd1322_surface_t *surface)
+{
+    ssd1322_surface_set_clip(surface, 0, 0, surface->width - 1, surface->height - 1);
+}
+
+uint32_t ssd1322_surface_fill(ssd1322_surface_t *surface, uint8_t data)
+{
+    uint32_t start = ssd1322_timestamp();
+    uint32_t bytes = surface->width >> 1;
+
+    if ((bytes == 0) || (surface->height == 0))
+    {
+        return 0;
+    }
+
+    if ((surface->x_byte == 0) && (surface->stride == bytes))
+    {
+        // Contiguous rows are filled as a single span
+        ssd1322_fill_span(surface->rows[0], data, bytes * surface->height);
+    }
+    else
+    {
+        for (uint8_t i = 0; i < surface->height; i++)
+        {
+            ssd1322_fill_span(ssd1322_surface_line(surface, i), data, bytes);
+        }
+    }
+
+    ssd1322_surface_mark(surface, 0, 0, bytes - 1, surface->height - 1);
+
+    return ssd1322_timestamp() - start;
+}
+
+void ssd1322_surface_put_pixel(ssd1322_surface_t *surface, int16_t x_virtual, int16_t y)
+{
+    if ((x_virtual < surface->clip_x_start) || (x_virtual > surface->clip_x_end) ||
+        (y < surface->clip_y_start) || (y > surface->clip_y_end))
+    {
+        return;
+    }
+
+    // Convert x from a virtual address to a physical address
+    // This is done by dividing by 2
+    uint32_t x_physical = (uint32_t) x_virtual >> 1;
+
+    // Check if the virtual address is odd or even.
+    // Two virtual addresses would provide the same physical address,
+    // so we'll need to determine which nibble to set.
+    // [0, 1] [2, 3] [4, 5]  ----> Virtual Address space
+    //    |      |      |
+    //    v      v      v
+    //    0      1      2    ----> Physical Address space
+
+    // An odd virtual address sets the right nibble, an even one the left
+    ssd1322_surface_line(surface, y)[x_physical] |= (x_virtual & 0x01) ? 0x0F : 0xF0;
+
+    ssd1322_surface_mark(surface, x_physical, y, x_physical, y);
+}
+
+void ssd1322_surface_put_horizontal_line(ssd1322_surface_t *surface,
+                                         uint16_t x,
+                                         uint8_t y,
+                                         uint16_t length)
+{
+    // Bytes with both pixels inside of the clip rectangle
+    int32_t x_start = x;
+    int32_t x_end = (int32_t) x + length - 1;
+    int32_t clip_start = (surface->clip_x_start + 1) >> 1;
+    int32_t clip_end = ((surface->clip_x_end + 1) >> 1) - 1;
+
+    x_start = (x_start < clip_start) ? clip_start : x_start;
+    x_end = (x_end > clip_end) ? clip_end : x_end;
+
+    if ((x_start > x_end) || (y < surface->clip_y_start) || (y > surface->clip_y_end))
+    {
+        return;
+    }
+
+    ssd1322_fill_span(ssd1322_surface_line(surface, y) + x_start, 0xFF,
+                      x_end - x_start + 1);
+
+    ssd1322_surface_mark(surface, x_start, y, x_end, y);
+}
+
+void ssd1322_surface_put_vertical_line(ssd1322_surface_t *surface,
+                                       uint16_t x,
+                                       uint8_t y,
+                                       uint8_t height,
+                                       uint8_t align)
+{
+    int32_t x_virtual = (x * 2) + ((align == ALIGN_RIGHT) ? 1 : 0);
+    int32_t y_start = (y < surface->clip_y_start) ? surface->clip_y_start : y;
+    int32_t y_end = (int32_t) y + height - 1;
+
+    y_end = (y_end > surface->clip_y_end) ? surface->clip_y_end : y_end;
+
+    if ((x_virtual < surface->clip_x_start) || (x_virtual > surface->clip_x_end) ||
+        (y_start > y_end) || ((align != ALIGN_LEFT) && (align != ALIGN_RIGHT)))
+    {
+        return;
+    }
+
+    uint8_t data = (align == ALIGN_LEFT) ? 0xF0 : 0x0F;
+
+    for (int32_t i = y_start; i <= y_end; i++)
+    {
+        ssd1322_surface_line(surface, i)[x] = data;
+    }
+
+    ssd1322_surface_mark(surface, x, y_start, x, y_end);
+}
+
+void ssd1322_surface_put_rectangle(ssd1322_surface_t *surface,
+                                   uint16_t x_1,
+                                   uint8_t y_1,
+                                   uint16_t x_2,
+                                   uint8_t y_2)
+{
+    ssd1322_surface_put_vertical_line(surface, x_1, y_1, (y_2 - y_1 + 1), ALIGN_LEFT);
+    ssd1322_surface_put_vertical_line(surface, x_2, y_1, (y_2 - y_1 + 1), ALIGN_RIGHT);
+    ssd1322_surface_put_horizontal_line(surface, x_1, y_1, (x_2 - x_1 + 1));
+    ssd1322_surface_put_horizontal_line(surface, x_1, y_2, (x_2 - x_1 + 1));
+}
+
+void ssd1322_surface_put_resource(ssd1322_surface_t *surface,
+                                  int16_t x_virtual,
+                                  int16_t y,
+                                  uint8_t rows,
+                                  uint8_t columns,
+                                  const uint8_t *resource_ptr)
+{
+    // Check if input pointers are valid
+    if (resource_ptr == NULL || rows == 0 || columns == 0)
+    {
+        // Exit if a pointer is invalid or there is nothing to draw
+        return;
+    }
+
+    ssd1322_surface_blit(surface, x_virtual, y, rows, columns * 2U,
+                         resource_ptr, columns);
+}
+
+void ssd1322_surface_put_surface(ssd1322_surface_t *surface,
+                                 int16_t x_virtual,
+                                 int16_t y,
+                                 const ssd1322_surface_t *source)
+{
+    if ((source->width == 0) || (source->height == 0))
+    {
+        return;
+    }
+
+    // Rows of a surface are evenly spaced, so they are walked by stride
+    ssd1322_surface_blit(surface, x_virtual, y, source->height, source->width,
+                         ssd1322_surface_line(source, 0), source->stride);
+}
+
+void ssd1322_surface_put_bitmap(ssd1322_surface_t *surface,
+                                int16_t x_virtual,
+                                int16_t y,
+                                const bitmap_t *bmp)
+{
+    // Display bitmap
+    ssd1322_surface_put_resource(surface, x_virtual, y, bmp->height, bmp->width,
+                                 bmp->address);
+}
+
+uint8_t ssd1322_surface_put_char(ssd1322_surface_t *surface,
+                                 int16_t x_virtual,
+                                 int16_t y,
+                                 const char c)
+{
+    // Check if character is valid or not
+    // Note: Character 127 is a special character we've added
+    // The actual representation for this character is 176
+    if (!(c >= 32 && c <= 127))
+    {
+        // Exit if the character does not exist
+        return 0;
+    }
+
+    // Fetch glyph metadata
+    uint16_t glyph_offset = g_active_font->font_table[c - ' '].glyph_location;
+    uint8_t columns       = g_active_font->font_table[c - ' '].glyph_width;
+    uint8_t rows          = g_active_font->font_table[c - ' '].glyph_height;
+    uint8_t baseline      = g_active_font->font_table[c - ' '].glyph_baseline;
+    uint8_t advance_width = g_active_font->font_table[c - ' '].glyph_advance_width;
+    // Get location of glyph in font
+    const uint8_t *glyph_address = g_active_font->address + glyph_offset;
+    // Calculate correct glyph baseline
+    y += baseline;
+    // Display glyph
+    ssd1322_surface_put_resource(surface, x_virtual, y, rows, columns, glyph_address);
+    // Return the current x coordinate of the frame buffer
+    return advance_width;
+}
+
+int16_t ssd1322_surface_put_string(ssd1322_surface_t *surface,
+                                   int16_t x_virtual,
+                                   int16_t y,
+                                   const char *string)
+{
+    while (*string)
+    {
+        x_virtual += ssd1322_surface_put_char(surface, x_virtual, y, *string++);
+    }
+
+    // Return the current x coordinate of the surface
+    return x_virtual;
+}
+
+void ssd1322_put_pixel_fb(uint8_t *fb, uint8_t x_virtual, uint8_t y)
+{
+    ssd1322_surface_put_pixel(ssd1322_fb_surface(fb), x_virtual, y);
+}
+
+void ssd1322_put_horizontal_line_fb(uint8_t *fb,
+                                    uint8_t x,
+                                    uint8_t y,
+                                    uint8_t length)
+{
+    ssd1322_surface_put_horizontal_line(ssd1322_fb_surface(fb), x, y, length);
+}
+
+void ssd1322_put_vertical_line_fb(uint8_t *fb,
+                                  uint8_t x,
+                                  uint8_t y,
+                                  uint8_t height,
+                                  uint8_t align)
+{
+    ssd1322_surface_put_vertical_line(ssd1322_fb_surface(fb), x, y, height, align);
+}
+
+void ssd1322_put_rectangle_fb(uint8_t *fb,
+                              uint8_t x_1,
                               uint8_t y_1,
                               uint8_t x_2,
                               uint8_t y_2)
 {
-    ssd1322_put_vertical_line_fb(fb, x_1, y_1, (y_2 - y_1 + 1), ALIGN_LEFT);
-    ssd1322_put_vertical_line_fb(fb, x_2, y_1, (y_2 - y_1 + 1), ALIGN_RIGHT);
-    ssd1322_put_horizontal_line_fb(fb, x_1, y_1, (x_2 - x_1 + 1));
-    ssd1322_put_horizontal_line_fb(fb, x_1, y_2, (x_2 - x_1 + 1));
+    ssd1322_surface_put_rectangle(ssd1322_fb_surface(fb), x_1, y_1, x_2, y_2);
 }
 
 void ssd1322_put_resource_fb(uint8_t *fb,
-                             uint8_t x_virtual,
-                             uint8_t y,
+                             int16_t x_virtual,
+                             int16_t y,
                              uint8_t rows,
                              uint8_t columns,
                              const uint8_t *resource_ptr)
 {
-    uint8_t x_physical = x_virtual >> 1;
-
-    // Check if there is enough space to draw the requested resource
-    if (((x_physical + columns) >= BUFFER_WIDTH) || ((y + rows) >= BUFFER_HEIGHT))
+    if (fb == NULL)
     {
-        // Exit if there is not enough space
+        // Exit if the frame buffer is invalid
         return;
     }
 
-    // Check if input pointers are valid
-    if (resource_ptr == NULL || fb == NULL)
+    ssd1322_surface_put_resource(ssd1322_fb_surface(fb), x_virtual, y,
+                                 rows, columns, resource_ptr);
+}
+
+void ssd1322_put_bitmap_fb(uint8_t *fb,
+                           int16_t x_virtual,
+                           int16_t y,
+                           const bitmap_t *bmp)
+{
+    ssd1322_surface_put_bitmap(ssd1322_fb_surface(fb), x_virtual, y, bmp);
+}
+
+uint8_t ssd1322_put_char_fb(uint8_t *fb, int16_t x_virtual, int16_t y, const char c)
+{
+    return ssd1322_surface_put_char(ssd1322_fb_surface(fb), x_virtual, y, c);
+}
+
+int16_t ssd1322_put_string_fb(uint8_t *fb,
+                              int16_t x_virtual,
+                              int16_t y,
+                              const char *string)
+{
+    return ssd1322_surface_put_string(ssd1322_fb_surface(fb), x_virtual, y, string);
+}
+
+void ssd1322_put_resource(uint8_t x_virtual,
+                          uint8_t y,
+                          uint8_t rows,
+                          uint8_t columns,
+                          const uint8_t *resource_ptr)
+{
+    // Check if there is enough space to draw the requested resource
+    if ((((uint32_t) x_virtual + (columns * 2U)) > DISPLAY_WIDTH) ||
+        (((uint32_t) y + rows) > BUFFER_HEIGHT) ||
+        (rows == 0) || (columns == 0) || (resource_ptr == NULL))
     {
-        // Exit if a pointer is invalid
+        // Exit if there is not enough space or nothing to draw
         return;
     }
 
-    // Check if the virtual address is even
-    if (!(x_virtual & 0x01))
+    // Each column address holds 4 pixels, pad the resource up to them
+    uint8_t column_start = x_virtual >> 2;
+    uint8_t column_end = (x_virtual + (columns * 2U) - 1) >> 2;
+    uint8_t pad = x_virtual & 0x03;
+    uint32_t width = (uint32_t) (column_end - column_start + 1) * 2U;
+
+    ssd1322_open_window(column_start, column_end, y, y + rows - 1);
+
+    for (uint8_t i = 0; i < rows; i++)
     {
-        // Display incoming pixels at the current physical x coordinate
-        for (uint8_t i = 0; i < rows; i++)
+        ssd1322_fill_span(g_line, IMMEDIATE_BACKGROUND, width);
+
+        if ((pad & 0x01) == 0)
         {
-            for (uint8_t j = 0; j < columns; j++)
-            {
-                fb[((y + i) * BUFFER_WIDTH) + x_physical + j] = *resource_ptr++;
-            }
+            // Whole bytes
+            memcpy(g_line + (pad >> 1), resource_ptr, columns);
         }
-    }
-    else
-    {
-        // If the virtual address is odd, do a pixel by pixel draw of the data
-        for (uint8_t i = 0; i < rows; i++)
+        else
         {
-            // The iterator j is in bytes. We have to convert it into nibbles
-            // Since 1 byte = 2 nibbles, we multiply by 2.
+            // The resource starts at a right nibble, shift it by a nibble
+            uint8_t *line = g_line + (pad >> 1);
+
             for (uint8_t j = 0; j < columns; j++)
             {
-                // Read data from resource
-                uint8_t data = *resource_ptr++;
-
-                // We write two pixels for one colum address because 
-                // a pixel is 4 bits and a column address represents 1 byte.
-                
-                // If there is data in the left nibble, display it at an odd address
-                if (data & 0xF0)
-                {
-                    // Initially the address is odd ...
-                    ssd1322_put_pixel_fb(fb, x_virtual + (j * 2), y + i);
-                }
-                // If there is data in the right nibble, display it at an even address
-                if (data & 0x0F)
-                {
-                    // ... then the address becomes even, and the cycle continues
-                    ssd1322_put_pixel_fb(fb, x_virtual + (j * 2) + 1, y + i);
-                }
+                line[j]     = (line[j] & 0xF0) | (resource_ptr[j] >> 4);
+                line[j + 1] = (line[j + 1] & 0x0F) | (uint8_t) (resource_ptr[j] << 4);
             }
         }
+
+        resource_ptr += columns;
+        g_transport->send_data(g_line, width);
     }
+
+    g_transport->deselect();
 }
 
-void ssd1322_put_bitmap_fb(uint8_t *fb,
-                           uint8_t x_virtual,
-                           uint8_t y,
-                           const bitmap_t *bmp)
+void ssd1322_put_bitmap(uint8_t x_virtual, uint8_t y, const bitmap_t *bmp)
 {
     // Display bitmap
-    ssd1322_put_resource_fb(fb, x_virtual, y, bmp->height, bmp->width, bmp->address);
+    ssd1322_put_resource(x_virtual, y, bmp->height, bmp->width, bmp->address);
 }
 
-uint8_t ssd1322_put_char_fb(uint8_t *fb, uint8_t x_virtual, uint8_t y, const char c)
+uint8_t ssd1322_put_char(uint8_t x_virtual, uint8_t y, const char c)
 {
     // Check if character is valid or not
     // Note: Character 127 is a special character we've added
-    // The actual representation for this character is 176
     if (!(c >= 32 && c <= 127))
     {
         // Exit if the character does not exist
@@ -623,50 +2406,389 @@ uint8_t ssd1322_put_char_fb(uint8_t *fb, uint8_t x_virtual, uint8_t y, const cha
     }
 
     // Fetch glyph metadata
-    uint16_t glyph_offset = g_active_font->font_table[c - ' '].glyph_location;
-    uint8_t columns       = g_active_font->font_table[c - ' '].glyph_width;
-    uint8_t rows          = g_active_font->font_table[c - ' '].glyph_height;
-    uint8_t baseline      = g_active_font->font_table[c - ' '].glyph_baseline;
-    uint8_t advance_width = g_active_font->font_table[c - ' '].glyph_advance_width;
-    // Get location of glyph in font
-    const uint8_t *glyph_address = g_active_font->address + glyph_offset;
-    // Calculate correct glyph baseline
-    y += baseline;
-    // Display glyph
-    ssd1322_put_resource_fb(fb, x_virtual, y, rows, columns, glyph_address);
-    // Return the current x coordinate of the frame buffer
-    return advance_width;
+    const font_table_entry_t *glyph = &g_active_font->font_table[c - ' '];
+    // Display glyph at the correct baseline
+    ssd1322_put_resource(x_virtual, y + glyph->glyph_baseline,
+                         glyph->glyph_height, glyph->glyph_width,
+                         g_active_font->address + glyph->glyph_location);
+    // Return the advance width of the glyph
+    return glyph->glyph_advance_width;
 }
 
-uint8_t ssd1322_put_string_fb(uint8_t *fb,
-                              uint8_t x_virtual,
-                              uint8_t y,
-                              const char *string)
+uint8_t ssd1322_put_string(uint8_t x_virtual, uint8_t y, const char *string)
 {
     while (*string)
     {
-        x_virtual += ssd1322_put_char_fb(fb, x_virtual, y, *string++);
+        x_virtual += ssd1322_put_char(x_virtual, y, *string++);
     }
 
-    // Return the current x coordinate of the frame buffer
+    // Return the current x coordinate
     return x_virtual;
 }
 
-void ssd1322_fill_fb(uint8_t *fb, uint8_t data)
+void ssd1322_put_rectangle(uint8_t x_1, uint8_t y_1, uint8_t x_2, uint8_t y_2)
+{
+    if ((x_2 < x_1) || (y_2 < y_1) ||
+        (x_2 >= BUFFER_WIDTH) || (y_2 >= BUFFER_HEIGHT))
+    {
+        // Exit if the rectangle is not on the display
+        return;
+    }
+
+    uint8_t column_1 = x_1 >> 1;
+    uint8_t column_2 = x_2 >> 1;
+
+    // Horizontal edges, bytes x_1 to x_2 are set
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        uint8_t y = i ? y_2 : y_1;
+
+        ssd1322_fill_span(g_line, IMMEDIATE_BACKGROUND, BUFFER_WIDTH);
+        ssd1322_fill_span(g_line + x_1, 0xFF, x_2 - x_1 + 1);
+
+        ssd1322_open_window(column_1, column_2, y, y);
+        g_transport->send_data(g_line + (column_1 * 2U),
+                               (uint32_t) (column_2 - column_1 + 1) * 2U);
+        g_transport->deselect();
+
+        if (y_1 == y_2)
+        {
+            break;
+        }
+    }
+
+    if (y_2 - y_1 < 2)
+    {
+        // There are no rows between the horizontal edges
+        return;
+    }
+
+    // Vertical edges, the left edge is the left nibble of byte x_1 and the
+    // right edge is the right nibble of byte x_2
+    uint8_t left[2] = {IMMEDIATE_BACKGROUND, IMMEDIATE_BACKGROUND};
+    uint8_t right[2] = {IMMEDIATE_BACKGROUND, IMMEDIATE_BACKGROUND};
+
+    left[x_1 & 0x01] = 0xF0;
+    right[x_2 & 0x01] = 0x0F;
+
+    if (column_1 == column_2)
+    {
+        // Both edges share a column address
+        left[0] |= right[0];
+        left[1] |= right[1];
+    }
+    else
+    {
+        ssd1322_fill_window(column_2, column_2, y_1 + 1, y_2 - 1,
+                            right[0], right[1]);
+    }
+
+    ssd1322_fill_window(column_1, column_1, y_1 + 1, y_2 - 1,
+                        left[0], left[1]);
+}
+
+uint32_t ssd1322_fill_fb(uint8_t *fb, uint8_t data)
+{
+    // The whole frame buffer is filled, whatever the clip rectangle
+    return ssd1322_surface_fill(ssd1322_fb_surface(fb), data);
+}
+
+void ssd1322_mark_dirty_fb(uint8_t x_virtual_start,
+                           uint8_t y_start,
+                           uint8_t x_virtual_end,
+                           uint8_t y_end)
+{
+    ssd1322_mark_dirty(x_virtual_start >> 1, y_start, x_virtual_end >> 1, y_end);
+}
+
+uint32_t ssd1322_flush_dirty_fb(uint8_t *fb)
+{
+    uint32_t sent = 0;
+
+    for (uint8_t i = 0; i < g_dirty_count; i++)
+    {
+        sent += ssd1322_send_rect(fb, &g_dirty[i]);
+    }
+
+    g_dirty_count = 0;
+
+    return sent;
+}
+
+uint32_t ssd1322_flush_diff_fb(uint8_t *fb)
 {
-    for (uint8_t i = 0; i < BUFFER_HEIGHT; i++)
+    ssd1322_rect_t window;
+    uint8_t window_open = 0;
+    // Windows sent below mark the hashes invalid, so check them up front
+    uint8_t valid = g_diff_valid;
+
+    g_diff_stats.rows_sent = 0;
+    g_diff_stats.rows_skipped = 0;
+    g_diff_stats.windows = 0;
+    g_diff_stats.bytes_sent = 0;
+
+    for (uint8_t y = 0; y < BUFFER_HEIGHT; y++)
     {
-        for (uint8_t j = 0; j < BUFFER_WIDTH; j++)
+        const uint32_t *words = (const uint32_t *) (fb + (y * BUFFER_WIDTH));
+        int8_t first = -1;
+        int8_t last = -1;
+
+        // Find the first and last changed segments of the row
+        for (uint8_t i = 0; i < DIFF_SEGMENTS; i++)
+        {
+            uint32_t hash = ssd1322_hash(words, SSD1322_DIFF_SEGMENT_BYTES / 4);
+            words += SSD1322_DIFF_SEGMENT_BYTES / 4;
+
+            if (!valid || (hash != g_diff_hash[y][i]))
+            {
+                if (first < 0)
+                {
+                    first = i;
+                }
+                last = i;
+                g_diff_hash[y][i] = hash;
+            }
+        }
+
+        if (first < 0)
+        {
+            g_diff_stats.rows_skipped++;
+            continue;
+        }
+
+        g_diff_stats.rows_sent++;
+
+        // Each column address holds 2 bytes
+        ssd1322_rect_t row =
+        {
+            .column_start = (first * SSD1322_DIFF_SEGMENT_BYTES) / 2,
+            .column_end   = ((last + 1) * SSD1322_DIFF_SEGMENT_BYTES) / 2 - 1,
+            .row_start    = y,
+            .row_end      = y,
+        };
+
+        if (!window_open)
+        {
+            window = row;
+            window_open = 1;
+            continue;
+        }
+
+        // Grow the window over this row (and any unchanged rows in between)
+        // if that costs less than sending the row through a new window
+        ssd1322_rect_t merged = window;
+        ssd1322_rect_union(&merged, &row);
+
+        if (ssd1322_rect_size(&merged) <=
+            ssd1322_rect_size(&window) + SSD1322_WINDOW_COST_BYTES +
+            ssd1322_rect_size(&row))
+        {
+            window = merged;
+        }
+        else
         {
-            fb[(i * BUFFER_WIDTH) + j] = data;
+            g_diff_stats.bytes_sent += ssd1322_send_rect(fb, &window);
+            g_diff_stats.windows++;
+            window = row;
         }
     }
+
+    if (window_open)
+    {
+        g_diff_stats.bytes_sent += ssd1322_send_rect(fb, &window);
+        g_diff_stats.windows++;
+    }
+
+    g_diff_valid = 1;
+
+    return g_diff_stats.bytes_sent;
+}
+
+void ssd1322_invalidate_diff_fb(void)
+{
+    g_diff_valid = 0;
+}
+
+void ssd1322_get_diff_stats(ssd1322_diff_stats_t *stats)
+{
+    *stats = g_diff_stats;
 }
 
 void ssd1322_display_fb(uint8_t *fb)
 {
-    // Start at the address (0, 0)
-    ssd1322_set_address(0, 0);
+    uint8_t page_row = ssd1322_frame_page_row();
+
+    // Start at the address (0, 0) of the page
+    ssd1322_set_page_address(page_row);
     // Send entire frame buffer to ssd1322
     ssd1322_write_data_buffer(fb, BUFFER_SIZE);
-}
\ No newline at end of file
+
+    if (page_row != g_page_row)
+    {
+        // Show the complete frame with a single command
+        ssd1322_set_start_line(page_row);
+        g_page_row = page_row;
+    }
+
+    // Nothing is left to flush
+    g_dirty_count = 0;
+}
+
+void ssd1322_display_fb_async(uint8_t *fb, ssd1322_callback_t callback)
+{
+    // Start at the address (0, 0) of the page
+    // This also waits for any previous transfer to complete
+    ssd1322_set_page_address(ssd1322_frame_page_row());
+
+    g_fb_transfer_busy = 1;
+    g_fb_transfer_callback = callback;
+    // The hidden page is shown by the first wait after the transfer
+    g_flip_pending = g_page_flip;
+    // Nothing is left to flush
+    g_dirty_count = 0;
+
+    // Chip select is released by the transfer complete handler
+    g_transport->select();
+    g_transport->send_data_async(fb, BUFFER_SIZE, ssd1322_transfer_complete);
+}
+
+uint8_t ssd1322_display_fb_busy(void)
+{
+    if (!g_fb_transfer_busy)
+    {
+        // Show the uploaded page if the transfer flipped pages
+        ssd1322_wait_transfer();
+    }
+
+    return g_fb_transfer_busy;
+}
+
+void ssd1322_set_page_flip(uint8_t enable)
+{
+    // Wait for any pending flip to complete
+    ssd1322_wait_transfer();
+
+    g_page_flip = enable;
+}
+
+void ssd1322_scroll_init(ssd1322_scroll_t *scroll, uint8_t *fb)
+{
+    scroll->fb = fb;
+    scroll->fb_row = 0;
+    scroll->start_line = g_page_row;
+
+    // The frame buffer is displayed as is to begin with
+    ssd1322_set_page_address(scroll->start_line);
+    ssd1322_write_data_buffer(fb, BUFFER_SIZE);
+    ssd1322_set_start_line(scroll->start_line);
+}
+
+void ssd1322_scroll_up(ssd1322_scroll_t *scroll,
+                       const uint8_t *rows,
+                       uint8_t count)
+{
+    while (count--)
+    {
+        // The GDDRAM row just below the display is exposed next
+        ssd1322_write_row((scroll->start_line + BUFFER_HEIGHT) % GDDRAM_HEIGHT,
+                          rows);
+        scroll->start_line = (scroll->start_line + 1) % GDDRAM_HEIGHT;
+        ssd1322_set_start_line(scroll->start_line);
+
+        // The top frame buffer row becomes the bottom row
+        memcpy(scroll->fb + (scroll->fb_row * BUFFER_WIDTH), rows, BUFFER_WIDTH);
+        scroll->fb_row = (scroll->fb_row + 1) % BUFFER_HEIGHT;
+
+        rows += BUFFER_WIDTH;
+    }
+}
+
+void ssd1322_scroll_down(ssd1322_scroll_t *scroll,
+                         const uint8_t *rows,
+                         uint8_t count)
+{
+    // Rows enter at the top, so the last row given goes in first
+    rows += (uint32_t) count * BUFFER_WIDTH;
+
+    while (count--)
+    {
+        rows -= BUFFER_WIDTH;
+
+        // The GDDRAM row just above the display is exposed next
+        scroll->start_line = (scroll->start_line + GDDRAM_HEIGHT - 1) %
+                             GDDRAM_HEIGHT;
+        ssd1322_write_row(scroll->start_line, rows);
+        ssd1322_set_start_line(scroll->start_line);
+
+        // The bottom frame buffer row becomes the top row
+        scroll->fb_row = (scroll->fb_row + BUFFER_HEIGHT - 1) % BUFFER_HEIGHT;
+        memcpy(scroll->fb + (scroll->fb_row * BUFFER_WIDTH), rows, BUFFER_WIDTH);
+    }
+}
+
+uint8_t *ssd1322_scroll_row(const ssd1322_scroll_t *scroll, uint8_t y)
+{
+    return scroll->fb + (((scroll->fb_row + y) % BUFFER_HEIGHT) * BUFFER_WIDTH);
+}
+
+void ssd1322_set_orientation(uint8_t orientation)
+{
+    ssd1322_stream_t stream;
+
+    g_remap_format = REMAP_DEFAULT;
+
+    if (orientation & ORIENTATION_MIRROR_X)
+    {
+        // Column address c now drives the columns of address
+        // GDDRAM_COLUMN_END - c. The display is centred in the GDDRAM, so
+        // it keeps the same column addresses.
+        g_remap_format ^= REMAP_COLUMN;
+    }
+    if (orientation & ORIENTATION_MIRROR_Y)
+    {
+        g_remap_format ^= REMAP_COM_SCAN;
+    }
+    if (orientation & ORIENTATION_NIBBLE_SWAP)
+    {
+        g_remap_format ^= REMAP_NIBBLE;
+    }
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_set_remap_format(&stream, g_remap_format);
+    ssd1322_stream_send(&stream);
+}
+
+uint8_t ssd1322_get_column_offset(void)
+{
+    return DISPLAY_COLUMN_START;
+}
+
+uint8_t ssd1322_get_page_row(void)
+{
+    // Include a flip pending on an asynchronous transfer
+    ssd1322_wait_transfer();
+
+    return g_page_row;
+}
+
+void ssd1322_fb_pair_init(ssd1322_fb_pair_t *pair, uint8_t *fb_0, uint8_t *fb_1)
+{
+    pair->back  = fb_0;
+    pair->front = fb_1;
+}
+
+uint8_t *ssd1322_fb_pair_swap(ssd1322_fb_pair_t *pair)
+{
+    // Wait for the front buffer to be released by the display
+    ssd1322_wait_transfer();
+
+    // Exchange ownership of the buffers
+    uint8_t *fb = pair->front;
+    pair->front = pair->back;
+    pair->back  = fb;
+
+    // Frame N streams out while frame N + 1 is drawn into the back buffer
+    ssd1322_display_fb_async(pair->front, NULL);
+
+    return pair->back;
+}
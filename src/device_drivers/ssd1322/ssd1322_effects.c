@@ -0,0 +1,695 @@
+/**
+ * @file   ssd1322_effects.c
+ * @author Adom Kwabena
+ * @brief  This module animates the SSD1322 through its control registers,
+ *         so effects cost a few command bytes per step instead of a frame.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include "ssd1322_effects.h"
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// Effect progress is a Q16 fixed point fraction
+#define PROGRESS_ONE                            65536UL
+
+// ****************************************************************************
+// * Module Data Structures
+// ****************************************************************************
+
+// Brightness animation
+typedef struct
+{
+    uint8_t active;
+    // Pulses go to the end values and back, fades only go there
+    uint8_t pulse;
+    uint8_t easing;
+    uint8_t contrast_start;
+    uint8_t contrast_end;
+    uint8_t master_start;
+    uint8_t master_end;
+    uint16_t count;
+    uint32_t start_ms;
+    uint32_t duration_ms;
+    ssd1322_effect_callback_t callback;
+} fade_t;
+
+// Display mode schedule
+typedef struct
+{
+    uint8_t active;
+    uint8_t flash_mode;
+    uint8_t restore_mode;
+    uint8_t length;
+    uint16_t count;
+    uint32_t pattern;
+    // Duration of set and clear pattern steps
+    uint32_t on_ms;
+    uint32_t off_ms;
+    // Duration of one repetition of the pattern
+    uint32_t period_ms;
+    uint32_t start_ms;
+    ssd1322_effect_callback_t callback;
+} flash_t;
+
+// Gray level animation
+typedef struct
+{
+    uint8_t active;
+    uint8_t gray_level;
+    uint8_t mode;
+    uint8_t easing;
+    uint8_t low;
+    uint8_t high;
+    uint32_t start_ms;
+    uint32_t period_ms;
+} palette_channel_t;
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+static fade_t g_fade = {0};
+
+static flash_t g_flash = {0};
+
+static palette_channel_t g_palette[SSD1322_PALETTE_CHANNELS] = {0};
+static uint8_t g_palette_count = 0;
+// Gray scale table to restore and whether it was a custom one
+static uint8_t g_palette_base[GRAY_SCALE_TABLE_SIZE];
+static uint8_t g_palette_base_custom = 0;
+// Gray scale table last uploaded
+static uint8_t g_palette_table[GRAY_SCALE_TABLE_SIZE];
+
+// ****************************************************************************
+// * Private Functions
+// ****************************************************************************
+
+/**
+ * @brief   This function applies an easing curve to a linear progress.
+ *
+ * @param   easing: The easing curve (EASE_*).
+ * @param   t: The linear progress (0 - PROGRESS_ONE).
+ * @returns The eased progress (0 - PROGRESS_ONE).
+ */
+static uint32_t ssd1322_ease(uint8_t easing, uint32_t t)
+{
+    uint32_t u = PROGRESS_ONE - t;
+
+    switch (easing)
+    {
+        case EASE_IN:
+            // t^2
+            return (t * (t >> 1)) >> 15;
+
+        case EASE_OUT:
+            // 1 - (1 - t)^2
+            return PROGRESS_ONE - ((u * (u >> 1)) >> 15);
+
+        case EASE_IN_OUT:
+            // t^2 * (3 - 2t)
+            return (((t * (t >> 1)) >> 15) * ((3 * PROGRESS_ONE - 2 * t) >> 2)) >> 14;
+
+        case EASE_LINEAR:
+        default:
+            return t;
+    }
+}
+
+/**
+ * @brief   This function computes the progress of a pulse, which goes from
+ *          0 to PROGRESS_ONE in the first half of a period and back.
+ *
+ * @param   elapsed: The time since the pulses started.
+ * @param   period: The duration of one pulse, at least 2.
+ * @returns The progress (0 - PROGRESS_ONE).
+ */
+static uint32_t ssd1322_triangle(uint32_t elapsed, uint32_t period)
+{
+    uint32_t phase = elapsed % period;
+    uint32_t half = period / 2;
+
+    if (phase < half)
+    {
+        return (uint32_t) (((uint64_t) phase * PROGRESS_ONE) / half);
+    }
+
+    return (uint32_t) (((uint64_t) (period - phase) * PROGRESS_ONE) / (period - half));
+}
+
+/**
+ * @brief   This function interpolates between two register values.
+ *
+ * @param   start: The value at progress 0.
+ * @param   end: The value at progress PROGRESS_ONE.
+ * @param   t: The progress (0 - PROGRESS_ONE).
+ * @returns The interpolated value.
+ */
+static inline uint8_t ssd1322_lerp(uint8_t start, uint8_t end, uint32_t t)
+{
+    int32_t delta = (int32_t) end - (int32_t) start;
+
+    return (uint8_t) (start + ((delta * (int32_t) (t >> 1)) >> 15));
+}
+
+/**
+ * @brief   This function sends the brightness of a point of the fade,
+ *          registers which already hold the value are not sent again.
+ *
+ * @param   contrast_current: The contrast current.
+ * @param   master_current: The master current.
+ * @returns None
+ */
+static void ssd1322_fade_apply(uint8_t contrast_current, uint8_t master_current)
+{
+    if (contrast_current != ssd1322_get_contrast())
+    {
+        ssd1322_set_contrast(contrast_current);
+    }
+
+    if (master_current != ssd1322_get_master_brightness())
+    {
+        ssd1322_set_master_brightness(master_current);
+    }
+}
+
+/**
+ * @brief   This function ends the fade and reports it.
+ *
+ * @param   completed: 1 if the fade ran to its end, 0 if it was cancelled.
+ * @returns None
+ */
+static void ssd1322_fade_end(uint8_t completed)
+{
+    ssd1322_effect_callback_t callback = g_fade.callback;
+
+    g_fade.active = 0;
+    g_fade.callback = NULL;
+
+    if (callback != NULL)
+    {
+        callback(completed);
+    }
+}
+
+/**
+ * @brief   This function advances the fade.
+ *
+ * @param   now_ms: The current time in milliseconds.
+ * @returns None
+ */
+static void ssd1322_fade_update(uint32_t now_ms)
+{
+    if (!g_fade.active)
+    {
+        return;
+    }
+
+    uint32_t elapsed = now_ms - g_fade.start_ms;
+
+    if (!g_fade.pulse)
+    {
+        if (elapsed >= g_fade.duration_ms)
+        {
+            ssd1322_fade_apply(g_fade.contrast_end, g_fade.master_end);
+            ssd1322_fade_end(1);
+            return;
+        }
+
+        uint32_t t = ssd1322_ease(g_fade.easing,
+                                  (uint32_t) (((uint64_t) elapsed * PROGRESS_ONE) /
+                                              g_fade.duration_ms));
+
+        ssd1322_fade_apply(ssd1322_lerp(g_fade.contrast_start, g_fade.contrast_end, t),
+                           ssd1322_lerp(g_fade.master_start, g_fade.master_end, t));
+        return;
+    }
+
+    uint32_t pulses = elapsed / g_fade.duration_ms;
+
+    if ((g_fade.count != EFFECT_FOREVER) && (pulses >= g_fade.count))
+    {
+        ssd1322_fade_apply(g_fade.contrast_start, g_fade.master_start);
+        ssd1322_fade_end(1);
+        return;
+    }
+
+    uint32_t t = ssd1322_ease(g_fade.easing,
+                              ssd1322_triangle(elapsed, g_fade.duration_ms));
+
+    ssd1322_fade_apply(ssd1322_lerp(g_fade.contrast_start, g_fade.contrast_end, t),
+                       g_fade.master_start);
+}
+
+/**
+ * @brief   This function uploads the gray scale table if it changed.
+ *
+ * @param   table: The gray scale table.
+ * @returns None
+ */
+static void ssd1322_palette_upload(const uint8_t *table)
+{
+    if (memcmp(table, g_palette_table, GRAY_SCALE_TABLE_SIZE) != 0)
+    {
+        memcpy(g_palette_table, table, GRAY_SCALE_TABLE_SIZE);
+        ssd1322_set_gray_scale_table(g_palette_table);
+    }
+}
+
+/**
+ * @brief   This function advances the palette animations.
+ *
+ * @param   now_ms: The current time in milliseconds.
+ * @returns None
+ */
+static void ssd1322_palette_update(uint32_t now_ms)
+{
+    if (g_palette_count == 0)
+    {
+        return;
+    }
+
+    uint8_t table[GRAY_SCALE_TABLE_SIZE];
+
+    memcpy(table, g_palette_base, GRAY_SCALE_TABLE_SIZE);
+
+    for (uint8_t i = 0; i < SSD1322_PALETTE_CHANNELS; i++)
+    {
+        palette_channel_t *channel = &g_palette[i];
+
+        if (!channel->active)
+        {
+            continue;
+        }
+
+        uint32_t elapsed = now_ms - channel->start_ms;
+        uint8_t value;
+
+        if (channel->mode == PALETTE_BLINK)
+        {
+            value = ((elapsed % channel->period_ms) < (channel->period_ms / 2)) ?
+                    channel->high : channel->low;
+        }
+        else
+        {
+            uint32_t t = ssd1322_ease(channel->easing,
+                                      ssd1322_triangle(elapsed, channel->period_ms));
+
+            value = ssd1322_lerp(channel->low, channel->high, t);
+        }
+
+        table[channel->gray_level - 1] = value;
+    }
+
+    ssd1322_palette_upload(table);
+}
+
+/**
+ * @brief   This function selects a display mode if it is not in use.
+ *
+ * @param   display_mode: The display mode.
+ * @returns None
+ */
+static inline void ssd1322_flash_apply(uint8_t display_mode)
+{
+    if (display_mode != ssd1322_get_display_mode())
+    {
+        ssd1322_select_display_mode(display_mode);
+    }
+}
+
+/**
+ * @brief   This function ends the flash, restores the display mode and
+ *          reports it.
+ *
+ * @param   completed: 1 if the flash ran to its end, 0 if it was cancelled.
+ * @returns None
+ */
+static void ssd1322_flash_end(uint8_t completed)
+{
+    ssd1322_effect_callback_t callback = g_flash.callback;
+
+    ssd1322_flash_apply(g_flash.restore_mode);
+
+    g_flash.active = 0;
+    g_flash.callback = NULL;
+
+    if (callback != NULL)
+    {
+        callback(completed);
+    }
+}
+
+/**
+ * @brief   This function advances the flash.
+ *
+ * @param   now_ms: The current time in milliseconds.
+ * @returns None
+ */
+static void ssd1322_flash_update(uint32_t now_ms)
+{
+    if (!g_flash.active)
+    {
+        return;
+    }
+
+    uint32_t elapsed = now_ms - g_flash.start_ms;
+
+    if ((g_flash.count != EFFECT_FOREVER) &&
+        ((elapsed / g_flash.period_ms) >= g_flash.count))
+    {
+        ssd1322_flash_end(1);
+        return;
+    }
+
+    // Find the step of the pattern being shown
+    uint32_t phase = elapsed % g_flash.period_ms;
+    uint8_t on = 0;
+
+    for (uint8_t step = 0; step < g_flash.length; step++)
+    {
+        on = (g_flash.pattern >> step) & 0x01;
+
+        uint32_t duration = on ? g_flash.on_ms : g_flash.off_ms;
+
+        if (phase < duration)
+        {
+            break;
+        }
+
+        phase -= duration;
+    }
+
+    ssd1322_flash_apply(on ? g_flash.flash_mode : g_flash.restore_mode);
+}
+
+/**
+ * @brief   This function starts a flash.
+ *
+ * @param   display_mode: The mode flashed in.
+ * @param   pattern: The blink pattern.
+ * @param   length: The number of steps in the pattern.
+ * @param   on_ms: The duration of set steps.
+ * @param   off_ms: The duration of clear steps.
+ * @param   count: The number of repetitions, or EFFECT_FOREVER.
+ * @param   now_ms: The current time in milliseconds.
+ * @param   callback: Function called when the flash ends, may be NULL.
+ * @returns None
+ */
+static void ssd1322_flash_start(uint8_t display_mode,
+                                uint32_t pattern,
+                                uint8_t length,
+                                uint32_t on_ms,
+                                uint32_t off_ms,
+                                uint16_t count,
+                                uint32_t now_ms,
+                                ssd1322_effect_callback_t callback)
+{
+    ssd1322_flash_cancel();
+
+    if (length == 0)
+    {
+        length = 1;
+    }
+    else if (length > FLASH_PATTERN_MAX)
+    {
+        length = FLASH_PATTERN_MAX;
+    }
+
+    // Steps have to take some time for the pattern to advance
+    on_ms = (on_ms == 0) ? 1 : on_ms;
+    off_ms = (off_ms == 0) ? 1 : off_ms;
+
+    g_flash.period_ms = 0;
+
+    for (uint8_t step = 0; step < length; step++)
+    {
+        g_flash.period_ms += ((pattern >> step) & 0x01) ? on_ms : off_ms;
+    }
+
+    g_flash.flash_mode = display_mode & 0x03;
+    g_flash.restore_mode = ssd1322_get_display_mode();
+    g_flash.pattern = pattern;
+    g_flash.length = length;
+    g_flash.on_ms = on_ms;
+    g_flash.off_ms = off_ms;
+    g_flash.count = count;
+    g_flash.start_ms = now_ms;
+    g_flash.callback = callback;
+    g_flash.active = 1;
+
+    ssd1322_flash_update(now_ms);
+}
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+void ssd1322_effects_update(uint32_t now_ms)
+{
+    ssd1322_fade_update(now_ms);
+    ssd1322_palette_update(now_ms);
+    ssd1322_flash_update(now_ms);
+}
+
+void ssd1322_fade_to(uint8_t contrast_current,
+                     uint8_t master_current,
+                     uint32_t duration_ms,
+                     uint8_t easing,
+                     uint32_t now_ms,
+                     ssd1322_effect_callback_t callback)
+{
+    ssd1322_fade_cancel(0);
+
+    g_fade.pulse = 0;
+    g_fade.easing = easing;
+    g_fade.contrast_start = ssd1322_get_contrast();
+    g_fade.contrast_end = contrast_current;
+    g_fade.master_start = ssd1322_get_master_brightness();
+    g_fade.master_end = master_current & 0x0F;
+    g_fade.count = 1;
+    g_fade.start_ms = now_ms;
+    g_fade.duration_ms = duration_ms;
+    g_fade.callback = callback;
+    g_fade.active = 1;
+
+    ssd1322_fade_update(now_ms);
+}
+
+void ssd1322_pulse(uint8_t contrast_current,
+                   uint32_t period_ms,
+                   uint16_t count,
+                   uint8_t easing,
+                   uint32_t now_ms,
+                   ssd1322_effect_callback_t callback)
+{
+    ssd1322_fade_cancel(0);
+
+    if (period_ms < 2)
+    {
+        // A pulse needs a way there and a way back
+        period_ms = 2;
+    }
+
+    g_fade.pulse = 1;
+    g_fade.easing = easing;
+    g_fade.contrast_start = ssd1322_get_contrast();
+    g_fade.contrast_end = contrast_current;
+    g_fade.master_start = ssd1322_get_master_brightness();
+    g_fade.master_end = g_fade.master_start;
+    g_fade.count = count;
+    g_fade.start_ms = now_ms;
+    g_fade.duration_ms = period_ms;
+    g_fade.callback = callback;
+    g_fade.active = 1;
+
+    ssd1322_fade_update(now_ms);
+}
+
+void ssd1322_fade_cancel(uint8_t restore)
+{
+    if (!g_fade.active)
+    {
+        return;
+    }
+
+    if (restore)
+    {
+        ssd1322_fade_apply(g_fade.contrast_start, g_fade.master_start);
+    }
+
+    ssd1322_fade_end(0);
+}
+
+uint8_t ssd1322_fade_busy(void)
+{
+    return g_fade.active;
+}
+
+uint8_t ssd1322_palette_animate(uint8_t gray_level,
+                                uint8_t low,
+                                uint8_t high,
+                                uint32_t period_ms,
+                                uint8_t mode,
+                                uint8_t easing,
+                                uint32_t now_ms)
+{
+    palette_channel_t *channel = NULL;
+
+    if ((gray_level == 0) || (gray_level > GRAY_SCALE_TABLE_SIZE))
+    {
+        return 0;
+    }
+
+    // Reuse the channel of the level, or else take a free one
+    for (uint8_t i = 0; i < SSD1322_PALETTE_CHANNELS; i++)
+    {
+        if (g_palette[i].active && (g_palette[i].gray_level == gray_level))
+        {
+            channel = &g_palette[i];
+            break;
+        }
+
+        if (!g_palette[i].active && (channel == NULL))
+        {
+            channel = &g_palette[i];
+        }
+    }
+
+    if (channel == NULL)
+    {
+        return 0;
+    }
+
+    if (g_palette_count == 0)
+    {
+        // Keep the table in use so it can be restored
+        g_palette_base_custom = ssd1322_get_gray_scale_table(g_palette_base);
+        memcpy(g_palette_table, g_palette_base, GRAY_SCALE_TABLE_SIZE);
+
+        // Make sure the table matches the copy, the default table is only
+        // close to it
+        if (!g_palette_base_custom)
+        {
+            ssd1322_set_gray_scale_table(g_palette_table);
+        }
+    }
+
+    if (!channel->active)
+    {
+        g_palette_count++;
+    }
+
+    if (period_ms < 2)
+    {
+        // A blink or pulse needs two halves
+        period_ms = 2;
+    }
+
+    channel->gray_level = gray_level;
+    channel->mode = mode;
+    channel->easing = easing;
+    channel->low = (low > GRAY_SCALE_MAX) ? GRAY_SCALE_MAX : low;
+    channel->high = (high > GRAY_SCALE_MAX) ? GRAY_SCALE_MAX : high;
+    channel->start_ms = now_ms;
+    channel->period_ms = period_ms;
+    channel->active = 1;
+
+    ssd1322_palette_update(now_ms);
+
+    return 1;
+}
+
+void ssd1322_palette_stop(uint8_t gray_level)
+{
+    for (uint8_t i = 0; i < SSD1322_PALETTE_CHANNELS; i++)
+    {
+        if (g_palette[i].active && (g_palette[i].gray_level == gray_level))
+        {
+            if (g_palette_count == 1)
+            {
+                ssd1322_palette_stop_all();
+                return;
+            }
+
+            g_palette[i].active = 0;
+            g_palette_count--;
+
+            // Give the level its pulse width back straight away
+            uint8_t table[GRAY_SCALE_TABLE_SIZE];
+
+            memcpy(table, g_palette_table, GRAY_SCALE_TABLE_SIZE);
+            table[gray_level - 1] = g_palette_base[gray_level - 1];
+            ssd1322_palette_upload(table);
+            return;
+        }
+    }
+}
+
+void ssd1322_palette_stop_all(void)
+{
+    if (g_palette_count == 0)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < SSD1322_PALETTE_CHANNELS; i++)
+    {
+        g_palette[i].active = 0;
+    }
+
+    // Restore the table in use before the animations
+    if (g_palette_base_custom)
+    {
+        ssd1322_palette_upload(g_palette_base);
+    }
+    else
+    {
+        ssd1322_select_default_gray_scale_table();
+    }
+
+    g_palette_count = 0;
+}
+
+void ssd1322_flash(uint8_t display_mode,
+                   uint32_t on_ms,
+                   uint32_t off_ms,
+                   uint16_t count,
+                   uint32_t now_ms,
+                   ssd1322_effect_callback_t callback)
+{
+    ssd1322_flash_start(display_mode, 0x01, 2, on_ms, off_ms,
+                        count, now_ms, callback);
+}
+
+void ssd1322_flash_pattern(uint8_t display_mode,
+                           uint32_t pattern,
+                           uint8_t length,
+                           uint32_t step_ms,
+                           uint16_t count,
+                           uint32_t now_ms,
+                           ssd1322_effect_callback_t callback)
+{
+    ssd1322_flash_start(display_mode, pattern, length, step_ms, step_ms,
+                        count, now_ms, callback);
+}
+
+void ssd1322_flash_cancel(void)
+{
+    if (g_flash.active)
+    {
+        ssd1322_flash_end(0);
+    }
+}
+
+uint8_t ssd1322_flash_busy(void)
+{
+    return g_flash.active;
+}
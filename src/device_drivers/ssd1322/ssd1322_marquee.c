@@ -0,0 +1,302 @@
+/**
+ * @file   ssd1322_marquee.c
+ * @author Adom Kwabena
+ * @brief  This module scrolls a line of text horizontally across a band of
+ *         the display (ticker / marquee).
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include "ssd1322_marquee.h"
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Row of the band being uploaded
+static uint8_t g_line[BUFFER_WIDTH];
+
+// ****************************************************************************
+// * Private Functions
+// ****************************************************************************
+
+/**
+ * @brief   This function sets a pixel of the ring of columns.
+ *
+ * @param   marquee: The marquee.
+ * @param   x: The ring pixel, it wraps around the ring.
+ * @param   row: The row of the band.
+ * @param   value: The gray level (0 - 15).
+ * @returns None
+ */
+static inline void ssd1322_marquee_set_pixel(ssd1322_marquee_t *marquee,
+                                             uint32_t x,
+                                             uint8_t row,
+                                             uint8_t value)
+{
+    x %= marquee->width;
+
+    uint8_t *byte = marquee->strip + (row * (marquee->width / 2U)) + (x >> 1);
+
+    if (x & 0x01)
+    {
+        // Odd pixels live in the right nibble
+        *byte = (*byte & 0xF0) | (value & 0x0F);
+    }
+    else
+    {
+        // Even pixels live in the left nibble
+        *byte = (*byte & 0x0F) | (value << 4);
+    }
+}
+
+/**
+ * @brief   This function clears columns of the ring.
+ *
+ * @param   marquee: The marquee.
+ * @param   x: The first ring pixel.
+ * @param   count: The number of pixels.
+ * @returns None
+ */
+static void ssd1322_marquee_clear(ssd1322_marquee_t *marquee,
+                                  uint32_t x,
+                                  uint32_t count)
+{
+    for (uint8_t row = 0; row < marquee->height; row++)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            ssd1322_marquee_set_pixel(marquee, x + i, row, 0x00);
+        }
+    }
+}
+
+/**
+ * @brief   This function renders the next character of the text (or the gap
+ *          after the text) into the ring.
+ *
+ * @param   marquee: The marquee.
+ * @param   font: The font to render with.
+ * @returns None
+ */
+static void ssd1322_marquee_render_next(ssd1322_marquee_t *marquee,
+                                        const font_t *font)
+{
+    char c = *marquee->next;
+
+    if (c == '\0')
+    {
+        // Leave a gap before the text starts over
+        ssd1322_marquee_clear(marquee, marquee->rendered, MARQUEE_GAP);
+        marquee->rendered += MARQUEE_GAP;
+        marquee->next = marquee->text;
+        return;
+    }
+
+    marquee->next++;
+
+    // Skip characters the font does not have
+    if (!(c >= 32 && c <= 127))
+    {
+        return;
+    }
+
+    // Fetch glyph metadata
+    const font_table_entry_t *glyph = &font->font_table[c - ' '];
+    const uint8_t *glyph_address = font->address + glyph->glyph_location;
+    uint32_t x = marquee->rendered;
+
+    ssd1322_marquee_clear(marquee, x, glyph->glyph_advance_width);
+
+    for (uint8_t i = 0; i < glyph->glyph_height; i++)
+    {
+        uint8_t row = glyph->glyph_baseline + i;
+
+        for (uint8_t j = 0; j < glyph->glyph_width; j++)
+        {
+            // A byte holds two pixels
+            uint8_t data = *glyph_address++;
+
+            if (row < marquee->height)
+            {
+                ssd1322_marquee_set_pixel(marquee, x + (j * 2), row, data >> 4);
+                ssd1322_marquee_set_pixel(marquee, x + (j * 2) + 1, row, data);
+            }
+        }
+    }
+
+    marquee->rendered += glyph->glyph_advance_width;
+}
+
+/**
+ * @brief   This function finds the widest advance of a font.
+ *
+ * @param   font: The font, may be NULL.
+ * @returns The widest advance in pixels, 0 without a font.
+ */
+static uint8_t ssd1322_marquee_widest(const font_t *font)
+{
+    uint8_t widest = 0;
+
+    if (font == NULL)
+    {
+        return 0;
+    }
+
+    // The font table holds the characters 32 - 127
+    for (uint8_t i = 0; i < MARQUEE_GLYPHS; i++)
+    {
+        if (font->font_table[i].glyph_advance_width > widest)
+        {
+            widest = font->font_table[i].glyph_advance_width;
+        }
+    }
+
+    return widest;
+}
+
+/**
+ * @brief   This function copies the visible part of a row of the ring into
+ *          the line buffer.
+ *
+ * @param   marquee: The marquee.
+ * @param   row: The row of the band.
+ * @returns None
+ */
+static void ssd1322_marquee_fetch_row(const ssd1322_marquee_t *marquee,
+                                      uint8_t row)
+{
+    uint32_t stride = marquee->width / 2U;
+    const uint8_t *ring = marquee->strip + (row * stride);
+    uint32_t x = marquee->position % marquee->width;
+    uint32_t byte = x >> 1;
+
+    if ((x & 0x01) == 0)
+    {
+        // Whole bytes, copied in at most two pieces around the wrap
+        uint32_t count = stride - byte;
+
+        if (count > BUFFER_WIDTH)
+        {
+            count = BUFFER_WIDTH;
+        }
+
+        memcpy(g_line, ring + byte, count);
+        memcpy(g_line + count, ring, BUFFER_WIDTH - count);
+        return;
+    }
+
+    // Odd pixel positions straddle two bytes, shift by a nibble
+    for (uint32_t i = 0; i < BUFFER_WIDTH; i++)
+    {
+        uint32_t next = (byte + 1 == stride) ? 0 : byte + 1;
+
+        g_line[i] = (uint8_t) ((ring[byte] << 4) | (ring[next] >> 4));
+        byte = next;
+    }
+}
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+uint8_t ssd1322_marquee_init(ssd1322_marquee_t *marquee,
+                             uint8_t *strip,
+                             uint16_t width,
+                             uint8_t height,
+                             uint8_t y)
+{
+    uint32_t ahead = ssd1322_marquee_widest(ssd1322_get_font());
+
+    // Glyphs and the gap are rendered past the right edge of the display
+    if (ahead < MARQUEE_GAP)
+    {
+        ahead = MARQUEE_GAP;
+    }
+
+    // Keep the band on the display
+    if (y >= BUFFER_HEIGHT)
+    {
+        y = BUFFER_HEIGHT - 1;
+    }
+    if ((y + height) > BUFFER_HEIGHT)
+    {
+        height = BUFFER_HEIGHT - y;
+    }
+
+    marquee->strip = strip;
+    marquee->width = width & ~0x01U;
+    marquee->height = height;
+    marquee->y = y;
+    marquee->text = "";
+    marquee->next = marquee->text;
+
+    if ((height == 0) || (marquee->width < (DISPLAY_WIDTH + ahead)))
+    {
+        // An empty band is never stepped
+        marquee->height = 0;
+        return 0;
+    }
+
+    memset(strip, 0x00, (uint32_t) height * (marquee->width / 2U));
+
+    ssd1322_marquee_set_text(marquee, NULL);
+
+    return 1;
+}
+
+void ssd1322_marquee_set_text(ssd1322_marquee_t *marquee, const char *text)
+{
+    marquee->text = (text != NULL) ? text : "";
+    marquee->next = marquee->text;
+
+    // The text enters from the right edge of the display
+    marquee->position = 0;
+    marquee->rendered = DISPLAY_WIDTH;
+
+    ssd1322_marquee_clear(marquee, 0, DISPLAY_WIDTH);
+}
+
+void ssd1322_marquee_step(ssd1322_marquee_t *marquee, uint8_t pixels)
+{
+    const font_t *font = ssd1322_get_font();
+    ssd1322_stream_t stream;
+
+    if ((font == NULL) || (marquee->height == 0))
+    {
+        // Exit if there is no font to render with or no band
+        return;
+    }
+
+    marquee->position += pixels;
+
+    // Render the glyphs entering the display into the ring
+    while (marquee->rendered < marquee->position + DISPLAY_WIDTH)
+    {
+        ssd1322_marquee_render_next(marquee, font);
+    }
+
+    // Only the rows of the band are uploaded
+    uint8_t row_start = ssd1322_get_page_row() + marquee->y;
+    uint8_t column_start = ssd1322_get_column_offset();
+
+    ssd1322_stream_begin(&stream);
+    ssd1322_stream_command(&stream, SET_COLUMN_ADDRESS);
+    ssd1322_stream_data(&stream, column_start);
+    ssd1322_stream_data(&stream, column_start + DISPLAY_COLUMNS - 1);
+    ssd1322_stream_command(&stream, SET_ROW_ADDRESS);
+    ssd1322_stream_data(&stream, row_start);
+    ssd1322_stream_data(&stream, row_start + marquee->height - 1);
+    ssd1322_stream_command(&stream, WRITE_RAM);
+    ssd1322_stream_send(&stream);
+
+    for (uint8_t row = 0; row < marquee->height; row++)
+    {
+        ssd1322_marquee_fetch_row(marquee, row);
+        ssd1322_write_data_buffer(g_line, BUFFER_WIDTH);
+    }
+}
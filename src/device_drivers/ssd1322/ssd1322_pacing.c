@@ -0,0 +1,197 @@
+/**
+ * @file   ssd1322_pacing.c
+ * @author Adom Kwabena
+ * @brief  This module paces frame flushes to the scan of the SSD1322.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stddef.h>
+#include "ssd1322_pacing.h"
+#include "stm32f407xx.h"
+#include "tim2.h"
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Panel frame rate (hundredths of a frame per second) and period
+static uint32_t g_panel_centihz = 0;
+static uint32_t g_period_ns = 0;
+// Target frame rate, never above the panel frame rate
+static volatile uint32_t g_target_centihz = 0;
+// Accumulates the target rate every tick, a frame is released each time
+// it reaches the panel rate. This drops ticks evenly and deterministically.
+static volatile uint32_t g_accumulator = 0;
+// Set when a frame is released, cleared when it is taken
+static volatile uint8_t g_ready = 0;
+static volatile ssd1322_pacing_stats_t g_stats = {0};
+
+// ****************************************************************************
+// * Private Functions
+// ****************************************************************************
+
+/**
+ * @brief   This function estimates the panel frame rate and period from
+ *          the refresh profile in use.
+ *
+ * @param   None
+ * @returns None
+ */
+static void ssd1322_pacing_estimate(void)
+{
+    ssd1322_refresh_info_t info;
+
+    ssd1322_estimate_refresh(NULL, &info);
+
+    g_panel_centihz = (info.frame_rate_centihz == 0) ? 1 : info.frame_rate_centihz;
+    g_period_ns = info.row_time_ns * ssd1322_get_refresh_profile()->multiplex_rows;
+}
+
+/**
+ * @brief   This function limits a target frame rate to the panel's.
+ *
+ * @param   target_centihz: The target frame rate, or PACING_PANEL_RATE.
+ * @returns The target frame rate to use.
+ */
+static inline uint32_t ssd1322_pacing_limit(uint32_t target_centihz)
+{
+    if ((target_centihz == PACING_PANEL_RATE) || (target_centihz > g_panel_centihz))
+    {
+        return g_panel_centihz;
+    }
+
+    return target_centihz;
+}
+
+/**
+ * @brief   This function is called by TIM2 once per panel frame.
+ *
+ * @param   None
+ * @returns None
+ */
+static void ssd1322_pacing_tick(void)
+{
+    g_stats.ticks++;
+    g_accumulator += g_target_centihz;
+
+    if (g_accumulator < g_panel_centihz)
+    {
+        return;
+    }
+
+    g_accumulator -= g_panel_centihz;
+
+    if (g_ready)
+    {
+        g_stats.missed++;
+    }
+
+    g_ready = 1;
+    g_stats.released++;
+}
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+void ssd1322_pacing_start(uint32_t target_centihz)
+{
+    ssd1322_pacing_estimate();
+
+    g_target_centihz = ssd1322_pacing_limit(target_centihz);
+    // Release the first frame on the first tick
+    g_accumulator = g_panel_centihz - g_target_centihz;
+    g_ready = 0;
+
+    tim2_start(g_period_ns, ssd1322_pacing_tick);
+}
+
+void ssd1322_pacing_stop(void)
+{
+    tim2_stop();
+
+    g_ready = 0;
+}
+
+void ssd1322_pacing_set_target(uint32_t target_centihz)
+{
+    __disable_irq();
+    g_target_centihz = ssd1322_pacing_limit(target_centihz);
+    g_accumulator = g_panel_centihz - g_target_centihz;
+    __enable_irq();
+}
+
+void ssd1322_pacing_refresh(void)
+{
+    uint32_t target_centihz = g_target_centihz;
+
+    __disable_irq();
+    ssd1322_pacing_estimate();
+    g_target_centihz = ssd1322_pacing_limit(target_centihz);
+    g_accumulator = g_panel_centihz - g_target_centihz;
+    __enable_irq();
+
+    tim2_set_period(g_period_ns);
+}
+
+void ssd1322_pacing_sync(void)
+{
+    tim2_restart();
+}
+
+uint8_t ssd1322_pacing_ready(void)
+{
+    uint8_t ready;
+
+    // Test and clear without a tick in between
+    __disable_irq();
+    ready = g_ready;
+    g_ready = 0;
+    __enable_irq();
+
+    return ready;
+}
+
+void ssd1322_pacing_wait(void)
+{
+    // The flag is checked with interrupts masked, so a tick cannot land
+    // between the check and WFI. A pending interrupt still wakes WFI up,
+    // it is taken once interrupts are enabled again.
+    __disable_irq();
+
+    while (!g_ready)
+    {
+        __WFI();
+        __enable_irq();
+        __disable_irq();
+    }
+
+    g_ready = 0;
+    __enable_irq();
+}
+
+uint32_t ssd1322_pacing_get_period(void)
+{
+    return g_period_ns;
+}
+
+void ssd1322_pacing_get_stats(ssd1322_pacing_stats_t *stats)
+{
+    __disable_irq();
+    stats->ticks = g_stats.ticks;
+    stats->released = g_stats.released;
+    stats->missed = g_stats.missed;
+    __enable_irq();
+}
+
+void ssd1322_pacing_reset_stats(void)
+{
+    __disable_irq();
+    g_stats.ticks = 0;
+    g_stats.released = 0;
+    g_stats.missed = 0;
+    __enable_irq();
+}
@@ -0,0 +1,134 @@
+/**
+ *  @file   ssd1322_transport_fsmc.c
+ *  @author Adom Kwabena
+ *  @brief  SSD1322 transport for the 8-bit 8080 parallel interface on the
+ *          FSMC. Chip select and data / command are driven by the FSMC
+ *          (NE1 and A16), only the reset line is a plain GPIO.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stddef.h>
+#include "fsmc.h"
+#include "ssd1322_transport.h"
+#include "stm32f407xx.h"
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// Use PORTA pin 2 as chip reset pin
+#define CHIP_RESET_HIGH()                       GPIOA->BSRR = GPIO_BSRR_BS_2
+#define CHIP_RESET_LOW()                        GPIOA->BSRR = GPIO_BSRR_BR_2
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Source of DMA fills, the DMA has to be able to reach it
+static uint8_t g_fill_data = 0;
+
+// ****************************************************************************
+// * Private Functions
+// ****************************************************************************
+
+static void fsmc_transport_init(void)
+{
+    // Enable GPIOA clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+
+    // Configure PA2 as a very high speed push pull output
+    GPIOA->MODER   &= ~(0x3UL << GPIO_MODER_MODER2_Pos);
+    GPIOA->MODER   |=  (0x1UL << GPIO_MODER_MODER2_Pos);
+    GPIOA->OSPEEDR |=  (0x3UL << GPIO_OSPEEDR_OSPEED2_Pos);
+    GPIOA->OTYPER  &= ~(0x1UL << GPIO_OTYPER_OT2_Pos);
+    GPIOA->PUPDR   &= ~(0x3UL << GPIO_PUPDR_PUPD2_Pos);
+
+    fsmc_init();
+}
+
+static void fsmc_transport_set_reset(uint8_t level)
+{
+    if (level)
+    {
+        CHIP_RESET_HIGH();
+    }
+    else
+    {
+        CHIP_RESET_LOW();
+    }
+}
+
+static void fsmc_transport_select(void)
+{
+    // The FSMC asserts chip select on every access
+}
+
+static void fsmc_transport_deselect(void)
+{
+    while (fsmc_dma_busy());
+}
+
+static void fsmc_transport_send_command(const uint8_t * bytes, uint32_t length)
+{
+    while (length--)
+    {
+        fsmc_write_command(*bytes++);
+    }
+}
+
+static void fsmc_transport_send_data(const uint8_t * bytes, uint32_t length)
+{
+    fsmc_write_data_buffer(bytes, length);
+}
+
+static void fsmc_transport_send_data_repeat(uint8_t data, uint32_t count)
+{
+#if SSD1322_FILL_USE_DMA
+    g_fill_data = data;
+    fsmc_write_data_repeat_dma(&g_fill_data, count, NULL);
+    while (fsmc_dma_busy());
+#else
+    fsmc_write_data_repeat(data, count);
+#endif
+}
+
+static void fsmc_transport_send_data_async(const uint8_t * bytes,
+                                           uint32_t length,
+                                           ssd1322_callback_t callback)
+{
+    fsmc_write_data_buffer_dma(bytes, length, callback);
+}
+
+static void fsmc_transport_wait_idle(void)
+{
+    while (fsmc_dma_busy());
+}
+
+static void fsmc_transport_read_data(uint8_t * bytes, uint32_t length)
+{
+    while (length--)
+    {
+        *bytes++ = fsmc_read_data();
+    }
+}
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+const ssd1322_transport_t ssd1322_transport_fsmc =
+{
+    .init             = fsmc_transport_init,
+    .set_reset        = fsmc_transport_set_reset,
+    .select           = fsmc_transport_select,
+    .deselect         = fsmc_transport_deselect,
+    .send_command     = fsmc_transport_send_command,
+    .send_data        = fsmc_transport_send_data,
+    .send_data_repeat = fsmc_transport_send_data_repeat,
+    .send_data_async  = fsmc_transport_send_data_async,
+    .wait_idle        = fsmc_transport_wait_idle,
+    .read_data        = fsmc_transport_read_data,
+};
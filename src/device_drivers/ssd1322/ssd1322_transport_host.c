@@ -0,0 +1,288 @@
+/**
+ *  @file   ssd1322_transport_host.c
+ *  @author Adom Kwabena
+ *  @brief  SSD1322 transport which writes into a memory image of the GDDRAM
+ *          instead of a bus. The addressing commands are emulated so the
+ *          driver can be tested and its bus traffic measured without a
+ *          display attached.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stddef.h>
+#include <string.h>
+#include "ssd1322_transport.h"
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// States of the data / command line
+#define LINE_COMMAND                            0
+#define LINE_DATA                               1
+#define LINE_UNKNOWN                            2
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Statistics and GDDRAM image
+static ssd1322_host_sink_t g_sink;
+
+// Current state of the data / command line
+static uint8_t g_data_command = LINE_UNKNOWN;
+
+// Last command received and the number of arguments received since
+static uint8_t g_command = 0;
+static uint8_t g_argument = 0;
+
+// Column (in bytes) and row windows of the GDDRAM
+static uint8_t g_column_start = 0;
+static uint8_t g_column_end = GDDRAM_WIDTH - 1;
+static uint8_t g_row_start = 0;
+static uint8_t g_row_end = GDDRAM_HEIGHT - 1;
+
+// Current GDDRAM address
+static uint8_t g_column = 0;
+static uint8_t g_row = 0;
+
+// ****************************************************************************
+// * Private Functions
+// ****************************************************************************
+
+/**
+ *  @brief   Moves to the next GDDRAM address, wrapping inside the window
+ *           like the SSD1322 does in horizontal address increment mode.
+ *  @param   None.
+ *  @returns None.
+ */
+static inline void host_transport_advance(void)
+{
+    if (g_column < g_column_end)
+    {
+        g_column++;
+        return;
+    }
+
+    g_column = g_column_start;
+    g_row = (g_row < g_row_end) ? g_row + 1 : g_row_start;
+}
+
+/**
+ *  @brief   Keeps track of the data / command line.
+ *  @param   state: LINE_COMMAND or LINE_DATA.
+ *  @returns None.
+ */
+static inline void host_transport_set_line(uint8_t state)
+{
+    if (g_data_command != state)
+    {
+        g_data_command = state;
+        g_sink.data_command_toggles++;
+    }
+}
+
+/**
+ *  @brief   Handles one argument of the last command or one byte of GDDRAM
+ *           data.
+ *  @param   data: The byte received.
+ *  @returns None.
+ */
+static inline void host_transport_data(uint8_t data)
+{
+    switch (g_command)
+    {
+        case SET_COLUMN_ADDRESS:
+            // Each column address holds 2 bytes
+            if (g_argument == 0)
+            {
+                g_column_start = (data % (GDDRAM_WIDTH / 2)) * 2;
+                g_column = g_column_start;
+            }
+            else if (g_argument == 1)
+            {
+                g_column_end = (data % (GDDRAM_WIDTH / 2)) * 2 + 1;
+            }
+            break;
+
+        case SET_ROW_ADDRESS:
+            if (g_argument == 0)
+            {
+                g_row_start = data % GDDRAM_HEIGHT;
+                g_row = g_row_start;
+            }
+            else if (g_argument == 1)
+            {
+                g_row_end = data % GDDRAM_HEIGHT;
+            }
+            break;
+
+        case SET_DISPLAY_START_LINE:
+            g_sink.start_line = data % GDDRAM_HEIGHT;
+            break;
+
+        case SET_REMAP_DUAL_COM_LINE_MODE:
+            if (g_argument == 0)
+            {
+                g_sink.remap_format = data;
+            }
+            break;
+
+        case WRITE_RAM:
+            g_sink.gddram[g_row][g_column] = data;
+            host_transport_advance();
+            break;
+
+        default:
+            break;
+    }
+
+    g_argument++;
+}
+
+static void host_transport_init(void)
+{
+    ssd1322_host_sink_reset();
+}
+
+static void host_transport_set_reset(uint8_t level)
+{
+    if (level == 0)
+    {
+        g_sink.resets++;
+    }
+}
+
+static void host_transport_select(void)
+{
+    g_sink.selects++;
+}
+
+static void host_transport_deselect(void)
+{
+}
+
+static void host_transport_send_command(const uint8_t * bytes, uint32_t length)
+{
+    host_transport_set_line(LINE_COMMAND);
+    g_sink.command_bytes += length;
+
+    while (length--)
+    {
+        g_command = *bytes++;
+        g_argument = 0;
+
+        if ((g_command == WRITE_RAM) || (g_command == READ_RAM))
+        {
+            g_column = g_column_start;
+            g_row = g_row_start;
+        }
+    }
+}
+
+static void host_transport_send_data(const uint8_t * bytes, uint32_t length)
+{
+    host_transport_set_line(LINE_DATA);
+    g_sink.data_bytes += length;
+
+    while (length--)
+    {
+        host_transport_data(*bytes++);
+    }
+}
+
+static void host_transport_send_data_repeat(uint8_t data, uint32_t count)
+{
+    host_transport_set_line(LINE_DATA);
+    g_sink.data_bytes += count;
+
+    while (count--)
+    {
+        host_transport_data(data);
+    }
+}
+
+static void host_transport_send_data_async(const uint8_t * bytes,
+                                           uint32_t length,
+                                           ssd1322_callback_t callback)
+{
+    // The transfer completes before returning
+    host_transport_send_data(bytes, length);
+
+    if (callback != NULL)
+    {
+        callback();
+    }
+}
+
+static void host_transport_wait_idle(void)
+{
+}
+
+static void host_transport_read_data(uint8_t * bytes, uint32_t length)
+{
+    host_transport_set_line(LINE_DATA);
+
+    while (length--)
+    {
+        if (g_command != READ_RAM)
+        {
+            *bytes++ = 0;
+            continue;
+        }
+
+        // The first read after READ_RAM returns dummy data
+        if (g_argument++ == 0)
+        {
+            *bytes++ = 0;
+            continue;
+        }
+
+        *bytes++ = g_sink.gddram[g_row][g_column];
+        host_transport_advance();
+    }
+}
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+const ssd1322_transport_t ssd1322_transport_host =
+{
+    .init             = host_transport_init,
+    .set_reset        = host_transport_set_reset,
+    .select           = host_transport_select,
+    .deselect         = host_transport_deselect,
+    .send_command     = host_transport_send_command,
+    .send_data        = host_transport_send_data,
+    .send_data_repeat = host_transport_send_data_repeat,
+    .send_data_async  = host_transport_send_data_async,
+    .wait_idle        = host_transport_wait_idle,
+    .read_data        = host_transport_read_data,
+};
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+void ssd1322_host_sink_reset(void)
+{
+    memset(&g_sink, 0, sizeof(g_sink));
+
+    g_data_command = LINE_UNKNOWN;
+    g_command = 0;
+    g_argument = 0;
+    g_column_start = 0;
+    g_column_end = GDDRAM_WIDTH - 1;
+    g_row_start = 0;
+    g_row_end = GDDRAM_HEIGHT - 1;
+    g_column = 0;
+    g_row = 0;
+}
+
+const ssd1322_host_sink_t * ssd1322_host_sink(void)
+{
+    return &g_sink;
+}
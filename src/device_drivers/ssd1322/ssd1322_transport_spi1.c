@@ -0,0 +1,412 @@
+/**
+ *  @file   ssd1322_transport_spi1.c
+ *  @author Adom Kwabena
+ *  @brief  SSD1322 transports for the 4-wire serial interface on SPI1.
+ *
+ *          Bulk data is sent as 16-bit frames when SSD1322_SPI_16BIT_DATA
+ *          is set, which halves the data register writes and TXE polls on
+ *          the polled path and the DMA requests of DMA fills. Buffers sent
+ *          by DMA keep 8-bit frames, 16-bit frames would need the caller's
+ *          bytes swapped. SPI1 is switched back to 8-bit frames for
+ *          commands.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stddef.h>
+#include "spi1.h"
+#include "ssd1322_transport.h"
+#include "stm32f407xx.h"
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// Hardware abstraction for GPIO
+// Use PORTA pin 0 as chip select pin
+#define CHIP_SELECT_HIGH()                      GPIOA->BSRR = GPIO_BSRR_BS_0
+#define CHIP_SELECT_LOW()                       GPIOA->BSRR = GPIO_BSRR_BR_0
+// Use PORTA pin 1 as data / command pin
+#define DATA_COMMAND_HIGH()                     GPIOA->BSRR = GPIO_BSRR_BS_1
+#define DATA_COMMAND_LOW()                      GPIOA->BSRR = GPIO_BSRR_BR_1
+// Use PORTA pin 2 as chip reset pin
+#define CHIP_RESET_HIGH()                       GPIOA->BSRR = GPIO_BSRR_BS_2
+#define CHIP_RESET_LOW()                        GPIOA->BSRR = GPIO_BSRR_BR_2
+
+// States of the data / command line
+#define LINE_COMMAND                            0
+#define LINE_DATA                               1
+#define LINE_UNKNOWN                            2
+
+// Shorter data phases are sent as bytes, switching the frame format
+// costs more than it saves
+#define FRAME_16BIT_MIN_LENGTH                  16U
+
+// Longer data phases are referenced by the transmit queue instead of copied
+#define QUEUE_COPY_MAX_LENGTH                   (SPI_QUEUE_INLINE_SIZE * 8U)
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+// Current state of the data / command line
+static uint8_t g_data_command = LINE_UNKNOWN;
+
+// Source of DMA fills, the DMA has to be able to reach it
+static uint8_t g_fill_data = 0;
+static uint16_t g_fill_data16 = 0;
+
+
+// ****************************************************************************
+// * Private Functions
+// ****************************************************************************
+
+/**
+ *  @brief   Initialize GPIOs connected to OLED display.
+ *  @param   None.
+ *  @returns None.
+ */
+static inline void spi1_transport_gpio_init(void)
+{
+    // Enable GPIOA clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+ 
+    // Configure PA0, PA1 and PA2 as output I/O.
+    GPIOA->MODER &=  ~(0x3UL << GPIO_MODER_MODER0_Pos) |
+                     ~(0x3UL << GPIO_MODER_MODER1_Pos) |
+                     ~(0x3UL << GPIO_MODER_MODER12_Pos);
+
+    GPIOA->MODER |=   (0x1UL << GPIO_MODER_MODER0_Pos) |
+                      (0x1UL << GPIO_MODER_MODER1_Pos) |
+                      (0x1UL << GPIO_MODER_MODER2_Pos);
+
+    // Configure PD4, PD12, PD13, PD14 & PD15 as very high speed I/O.
+    GPIOA->OSPEEDR |= (0x3UL << GPIO_OSPEEDR_OSPEED0_Pos) |
+                      (0x3UL << GPIO_OSPEEDR_OSPEED1_Pos) |
+                      (0x3UL << GPIO_OSPEEDR_OSPEED2_Pos);
+
+    // Configure PD4, PD12, PD13, PD14 & PD15 as push pull I/O.
+    GPIOA->OTYPER &= ~(0x1UL << GPIO_OTYPER_OT0_Pos) |
+                     ~(0x1UL << GPIO_OTYPER_OT1_Pos) |
+                     ~(0x1UL << GPIO_OTYPER_OT2_Pos);
+
+    // Disable pull up/pull down functionality on PD4, PD12, PD13, PD14 & PD15.
+    GPIOA->PUPDR &=  ~(0x3UL << GPIO_PUPDR_PUPD0_Pos) |
+                     ~(0x3UL << GPIO_PUPDR_PUPD1_Pos) |
+                     ~(0x3UL << GPIO_PUPDR_PUPD12_Pos);
+
+    CHIP_SELECT_HIGH();
+    g_data_command = LINE_UNKNOWN;
+}
+
+/**
+ *  @brief   Drives the data / command line, bytes still being shifted out
+ *           are sent before the line changes.
+ *  @param   state: LINE_COMMAND or LINE_DATA.
+ *  @returns None.
+ */
+static inline void spi1_transport_set_line(uint8_t state)
+{
+    if (g_data_command == state)
+    {
+        return;
+    }
+
+    // The last byte has to leave the shift register first
+    spi1_wait_idle();
+
+    if (state == LINE_DATA)
+    {
+        DATA_COMMAND_HIGH();
+    }
+    else
+    {
+        DATA_COMMAND_LOW();
+    }
+
+    g_data_command = state;
+}
+
+/**
+ *  @brief   Checks if a data phase should be sent as 16-bit frames.
+ *  @param   length: The number of bytes in the data phase.
+ *  @returns 1 for 16-bit frames, 0 for bytes.
+ */
+static inline uint8_t spi1_transport_use_16bit(uint32_t length)
+{
+    return SSD1322_SPI_16BIT_DATA && (length >= FRAME_16BIT_MIN_LENGTH);
+}
+
+static void spi1_transport_init(void)
+{
+    spi1_transport_gpio_init();
+    spi1_init(SPI_MODE_3);
+}
+
+static void spi1_transport_dma_init(void)
+{
+    spi1_transport_gpio_init();
+    spi1_init(SPI_MODE_3);
+    spi1_dma_init();
+}
+
+static void spi1_transport_set_reset(uint8_t level)
+{
+    if (level)
+    {
+        CHIP_RESET_HIGH();
+    }
+    else
+    {
+        CHIP_RESET_LOW();
+    }
+}
+
+static void spi1_transport_select(void)
+{
+    CHIP_SELECT_LOW();
+}
+
+static void spi1_transport_deselect(void)
+{
+    spi1_wait_idle();
+    CHIP_SELECT_HIGH();
+}
+
+static void spi1_transport_send(const uint8_t * bytes, uint32_t length)
+{
+    while (length--)
+    {
+        spi1_write(*bytes++);
+    }
+}
+
+static void spi1_transport_send_command(const uint8_t * bytes, uint32_t length)
+{
+    spi1_transport_set_line(LINE_COMMAND);
+    spi1_set_frame_format(SPI_FRAME_8BIT);
+    spi1_transport_send(bytes, length);
+}
+
+static void spi1_transport_send_data(const uint8_t * bytes, uint32_t length)
+{
+    spi1_transport_set_line(LINE_DATA);
+
+    if (spi1_transport_use_16bit(length))
+    {
+        spi1_set_frame_format(SPI_FRAME_16BIT);
+        spi1_transmit_buffer16(bytes, length >> 1);
+
+        // An odd trailing byte is sent on its own
+        bytes += length & ~0x01UL;
+        length &= 0x01;
+    }
+
+    spi1_set_frame_format(SPI_FRAME_8BIT);
+    spi1_transport_send(bytes, length);
+}
+
+static void spi1_transport_send_data_repeat(uint8_t data, uint32_t count)
+{
+    spi1_transport_set_line(LINE_DATA);
+
+    if (spi1_transport_use_16bit(count))
+    {
+        spi1_set_frame_format(SPI_FRAME_16BIT);
+        spi1_transmit_repeat16(((uint16_t) data << 8) | data, count >> 1);
+        count &= 0x01;
+    }
+
+    spi1_set_frame_format(SPI_FRAME_8BIT);
+    spi1_transmit_repeat(data, count);
+}
+
+static void spi1_transport_send_data_async(const uint8_t * bytes,
+                                           uint32_t length,
+                                           ssd1322_callback_t callback)
+{
+    // Without DMA the transfer completes before returning
+    spi1_transport_send_data(bytes, length);
+    spi1_wait_idle();
+
+    if (callback != NULL)
+    {
+        callback();
+    }
+}
+
+static void spi1_transport_dma_send_data_repeat(uint8_t data, uint32_t count)
+{
+#if SSD1322_FILL_USE_DMA
+    spi1_transport_set_line(LINE_DATA);
+    spi1_wait_idle();
+
+    if (spi1_transport_use_16bit(count))
+    {
+        spi1_set_frame_format(SPI_FRAME_16BIT);
+
+        g_fill_data16 = ((uint16_t) data << 8) | data;
+        spi1_transmit_repeat16_dma(&g_fill_data16, count >> 1, NULL);
+        while (spi1_dma_busy());
+
+        count &= 0x01;
+    }
+
+    spi1_set_frame_format(SPI_FRAME_8BIT);
+
+    if (count != 0)
+    {
+        g_fill_data = data;
+        spi1_transmit_repeat_dma(&g_fill_data, count, NULL);
+        while (spi1_dma_busy());
+    }
+#else
+    spi1_transport_send_data_repeat(data, count);
+#endif
+}
+
+static void spi1_transport_dma_send_data_async(const uint8_t * bytes,
+                                               uint32_t length,
+                                               ssd1322_callback_t callback)
+{
+    spi1_transport_set_line(LINE_DATA);
+    spi1_wait_idle();
+
+    // 16-bit frames are sent MSB first, so they would need the buffer byte
+    // swapped. The DMA requests they save cost the CPU nothing, keep bytes.
+    spi1_set_frame_format(SPI_FRAME_8BIT);
+    spi1_transmit_buffer_dma(bytes, length, callback);
+}
+
+static void spi1_transport_dma_wait_idle(void)
+{
+    while (spi1_dma_busy());
+    spi1_wait_idle();
+}
+
+static void spi1_transport_queue_select(uint8_t level)
+{
+    if (level)
+    {
+        CHIP_SELECT_LOW();
+    }
+    else
+    {
+        CHIP_SELECT_HIGH();
+    }
+}
+
+static void spi1_transport_queue_data_command(uint8_t level)
+{
+    if (level)
+    {
+        DATA_COMMAND_HIGH();
+    }
+    else
+    {
+        DATA_COMMAND_LOW();
+    }
+}
+
+static void spi1_transport_irq_init(void)
+{
+    spi1_transport_gpio_init();
+    spi1_init(SPI_MODE_3);
+    spi1_queue_init(spi1_transport_queue_select,
+                    spi1_transport_queue_data_command);
+}
+
+static void spi1_transport_irq_select(void)
+{
+    // The transmit queue asserts chip select before the first byte
+}
+
+static void spi1_transport_irq_deselect(void)
+{
+    spi1_queue_release(NULL);
+}
+
+static void spi1_transport_irq_send_command(const uint8_t * bytes,
+                                            uint32_t length)
+{
+    spi1_queue_push_copy(SPI_SEGMENT_COMMAND, bytes, length);
+}
+
+static void spi1_transport_irq_send_data(const uint8_t * bytes,
+                                         uint32_t length)
+{
+    if (length <= QUEUE_COPY_MAX_LENGTH)
+    {
+        spi1_queue_push_copy(SPI_SEGMENT_DATA, bytes, length);
+        return;
+    }
+
+    // The caller may reuse the buffer once this returns
+    spi1_queue_push(SPI_SEGMENT_DATA, bytes, length);
+    spi1_queue_flush();
+}
+
+static void spi1_transport_irq_send_data_repeat(uint8_t data, uint32_t count)
+{
+    spi1_queue_push_repeat(SPI_SEGMENT_DATA, data, count);
+}
+
+static void spi1_transport_irq_send_data_async(const uint8_t * bytes,
+                                               uint32_t length,
+                                               ssd1322_callback_t callback)
+{
+    spi1_queue_push(SPI_SEGMENT_DATA, bytes, length);
+
+    if (callback != NULL)
+    {
+        spi1_queue_notify(callback);
+    }
+}
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+const ssd1322_transport_t ssd1322_transport_spi1 =
+{
+    .init             = spi1_transport_init,
+    .set_reset        = spi1_transport_set_reset,
+    .select           = spi1_transport_select,
+    .deselect         = spi1_transport_deselect,
+    .send_command     = spi1_transport_send_command,
+    .send_data        = spi1_transport_send_data,
+    .send_data_repeat = spi1_transport_send_data_repeat,
+    .send_data_async  = spi1_transport_send_data_async,
+    .wait_idle        = spi1_wait_idle,
+    .read_data        = NULL,
+};
+
+const ssd1322_transport_t ssd1322_transport_spi1_dma =
+{
+    .init             = spi1_transport_dma_init,
+    .set_reset        = spi1_transport_set_reset,
+    .select           = spi1_transport_select,
+    .deselect         = spi1_transport_deselect,
+    .send_command     = spi1_transport_send_command,
+    .send_data        = spi1_transport_send_data,
+    .send_data_repeat = spi1_transport_dma_send_data_repeat,
+    .send_data_async  = spi1_transport_dma_send_data_async,
+    .wait_idle        = spi1_transport_dma_wait_idle,
+    .read_data        = NULL,
+};
+
+const ssd1322_transport_t ssd1322_transport_spi1_irq =
+{
+    .init             = spi1_transport_irq_init,
+    .set_reset        = spi1_transport_set_reset,
+    .select           = spi1_transport_irq_select,
+    .deselect         = spi1_transport_irq_deselect,
+    .send_command     = spi1_transport_irq_send_command,
+    .send_data        = spi1_transport_irq_send_data,
+    .send_data_repeat = spi1_transport_irq_send_data_repeat,
+    .send_data_async  = spi1_transport_irq_send_data_async,
+    .wait_idle        = spi1_queue_flush,
+    .read_data        = NULL,
+};
@@ -8,6 +8,7 @@
 // * Include Files.
 // ****************************************************************************
 
+#include <stddef.h>
 #include "stm32f407xx.h"
 #include "gpio.h"
 #include "spi1.h"
@@ -17,6 +18,7 @@
 #include "i2c1_test.h"
 #include "delay.h"
 #include "ssd1322.h"
+#include "ssd1322_pacing.h"
 #include "itoa.h"
 #include "ftoa.h"
 #include "hdc1000.h"
@@ -39,7 +41,11 @@
 // * Global Variables.
 // ****************************************************************************
 
-uint8_t frame_buffer[8192] __attribute__((section(".ccm"))) = {};
+// The frame buffers are kept in SRAM (not CCM) so that the DMA can reach them.
+// Word alignment lets them be byte swapped a word at a time for 16-bit frames.
+uint8_t frame_buffer[8192] __attribute__((aligned(4))) = {};
+uint8_t back_buffer[8192] __attribute__((aligned(4))) = {};
+ssd1322_fb_pair_t frame_buffers;
 volatile uint32_t frames = 0;
 volatile uint32_t fps = 0;
 
@@ -205,6 +211,13 @@ int main(void)
         float v_sense = 0;
         float v_refint = 0;
 
+        // Render into one frame buffer while the other one is displayed
+        ssd1322_fb_pair_init(&frame_buffers, frame_buffer, back_buffer);
+        uint8_t *fb = frame_buffers.back;
+
+        // Release a frame on every panel frame
+        ssd1322_pacing_start(PACING_PANEL_RATE);
+
         while (1)
         {
             // Connect ADC1_IN16 to SQ1
@@ -248,41 +261,45 @@ int main(void)
             ftoa(humidity, string_1);
             ftoa(temperature, string_2);
             itoa(counter, string_3);
-            ssd1322_fill_fb(frame_buffer, 0x00);
+
+            ssd1322_fill_fb(fb, 0x00);
             ssd1322_set_font((const font_t *)&UbuntuMono_Regular_30);
-            x_coord = ssd1322_put_string_fb(frame_buffer, 0, 0, "H:");
-            x_coord = ssd1322_put_string_fb(frame_buffer, x_coord, 0, string_1);
-            ssd1322_put_char_fb(frame_buffer, x_coord, 0, '%');
+            x_coord = ssd1322_put_string_fb(fb, 0, 0, "H:");
+            x_coord = ssd1322_put_string_fb(fb, x_coord, 0, string_1);
+            ssd1322_put_char_fb(fb, x_coord, 0, '%');
 
-            x_coord = ssd1322_put_string_fb(frame_buffer, 0, 32, "T:");
-            x_coord = ssd1322_put_string_fb(frame_buffer, x_coord, 32, string_2);
-            x_coord += ssd1322_put_char_fb(frame_buffer, x_coord, 32, (const char) 127);
-            ssd1322_put_char_fb(frame_buffer, x_coord, 32, 'C');
+            x_coord = ssd1322_put_string_fb(fb, 0, 32, "T:");
+            x_coord = ssd1322_put_string_fb(fb, x_coord, 32, string_2);
+            x_coord += ssd1322_put_char_fb(fb, x_coord, 32, (const char) 127);
+            ssd1322_put_char_fb(fb, x_coord, 32, 'C');
 
             ssd1322_set_font((const font_t *)&UbuntuMono_Regular_15);
-            x_coord = ssd1322_put_string_fb(frame_buffer, 149, 0, "Frames:");
-            ssd1322_put_string_fb(frame_buffer, x_coord, 0, string_3);
+            x_coord = ssd1322_put_string_fb(fb, 149, 0, "Frames:");
+            ssd1322_put_string_fb(fb, x_coord, 0, string_3);
             // We are counting the frames every 1/2 a second so fps is
             // multiplied by 2 to get the actual fps.
             itoa((fps * 2), string_4);
-            x_coord = ssd1322_put_string_fb(frame_buffer, 149, 16, "FPS:");
-            ssd1322_put_string_fb(frame_buffer, x_coord, 16, string_4);
+            x_coord = ssd1322_put_string_fb(fb, 149, 16, "FPS:");
+            ssd1322_put_string_fb(fb, x_coord, 16, string_4);
 
             // Display internal chip temperature
-            x_coord = ssd1322_put_string_fb(frame_buffer, 149, 32, "Temp:");
-            x_coord = ssd1322_put_string_fb(frame_buffer, x_coord, 32, string_5);
-            x_coord += ssd1322_put_char_fb(frame_buffer, x_coord, 32, (const char) 127);
-            ssd1322_put_char_fb(frame_buffer, x_coord, 32, 'C');
+            x_coord = ssd1322_put_string_fb(fb, 149, 32, "Temp:");
+            x_coord = ssd1322_put_string_fb(fb, x_coord, 32, string_5);
+            x_coord += ssd1322_put_char_fb(fb, x_coord, 32, (const char) 127);
+            ssd1322_put_char_fb(fb, x_coord, 32, 'C');
             
             // Display internal chip temperature
-            x_coord = ssd1322_put_string_fb(frame_buffer, 149, 48, "Vref:");
-            x_coord = ssd1322_put_string_fb(frame_buffer, x_coord, 48, string_6);
-            ssd1322_put_char_fb(frame_buffer, x_coord, 48, 'V');
+            x_coord = ssd1322_put_string_fb(fb, 149, 48, "Vref:");
+            x_coord = ssd1322_put_string_fb(fb, x_coord, 48, string_6);
+            ssd1322_put_char_fb(fb, x_coord, 48, 'V');
+
+            // Flush at a steady phase of the panel scan
+            ssd1322_pacing_wait();
 
             // Toggle bit 14 to indicate fps, where fps = freq at which 
             // orange LED toggles.
             ORANGE_LED_ON();
-            ssd1322_display_fb(frame_buffer);
+            fb = ssd1322_fb_pair_swap(&frame_buffers);
             ORANGE_LED_OFF();
             counter++;
             frames++;
@@ -0,0 +1,72 @@
+/**
+ *  @file   stm32f407xx.h
+ *  @author Adom Kwabena
+ *  @brief  Host stand-in for the device header. The real header provides
+ *          the register layouts and bit definitions, then the peripherals
+ *          used by the drivers under test are pointed at register blocks
+ *          in RAM, so tests can inspect what a driver programmed and play
+ *          the part of the hardware by setting status flags.
+ *
+ *          tests/mock has to come before include/system in the include
+ *          path. The register blocks live in tests/mock_registers.c.
+ */
+
+// Prevent multiple file inclusion
+#ifndef __MOCK_STM32F407XX_INC__
+#define __MOCK_STM32F407XX_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include_next "stm32f407xx.h"
+
+// ****************************************************************************
+// * Mocked Register Blocks
+// ****************************************************************************
+
+extern RCC_TypeDef        mock_rcc;
+extern GPIO_TypeDef       mock_gpioa;
+extern SPI_TypeDef        mock_spi1;
+extern DMA_TypeDef        mock_dma2;
+extern DMA_Stream_TypeDef mock_dma2_stream1;
+extern DMA_Stream_TypeDef mock_dma2_stream3;
+extern CRC_TypeDef        mock_crc;
+extern DWT_Type           mock_dwt;
+
+// Interrupts enabled through NVIC_EnableIRQ, one bit per IRQn
+extern uint32_t           mock_nvic_enabled[3];
+
+#undef  RCC
+#define RCC               (&mock_rcc)
+#undef  GPIOA
+#define GPIOA             (&mock_gpioa)
+#undef  SPI1
+#define SPI1              (&mock_spi1)
+#undef  DMA2
+#define DMA2              (&mock_dma2)
+#undef  DMA2_Stream1
+#define DMA2_Stream1      (&mock_dma2_stream1)
+#undef  DMA2_Stream3
+#define DMA2_Stream3      (&mock_dma2_stream3)
+#undef  CRC
+#define CRC               (&mock_crc)
+#undef  DWT
+#define DWT               (&mock_dwt)
+
+// The CMSIS NVIC functions were compiled against the real NVIC address
+#undef  NVIC_EnableIRQ
+#define NVIC_EnableIRQ(irq)     (mock_nvic_enabled[(irq) >> 5] |=  (1UL << ((irq) & 0x1F)))
+#undef  NVIC_DisableIRQ
+#define NVIC_DisableIRQ(irq)    (mock_nvic_enabled[(irq) >> 5] &= ~(1UL << ((irq) & 0x1F)))
+#undef  NVIC_SetPriority
+#define NVIC_SetPriority(irq, priority)    ((void) (irq), (void) (priority))
+
+/**
+ *  @brief   Clears every mocked register block.
+ *  @param   None.
+ *  @returns None.
+ */
+void mock_registers_reset(void);
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ *  @file   mock_registers.c
+ *  @author Adom Kwabena
+ *  @brief  Register blocks in RAM standing in for the peripherals of the
+ *          stm32f407vgt6 in host builds.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <string.h>
+#include "stm32f407xx.h"
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+RCC_TypeDef        mock_rcc;
+GPIO_TypeDef       mock_gpioa;
+SPI_TypeDef        mock_spi1;
+DMA_TypeDef        mock_dma2;
+DMA_Stream_TypeDef mock_dma2_stream1;
+DMA_Stream_TypeDef mock_dma2_stream3;
+CRC_TypeDef        mock_crc;
+DWT_Type           mock_dwt;
+uint32_t           mock_nvic_enabled[3];
+
+// ****************************************************************************
+// * Module APIs
+// ****************************************************************************
+
+void mock_registers_reset(void)
+{
+    memset(&mock_rcc, 0, sizeof(mock_rcc));
+    memset(&mock_gpioa, 0, sizeof(mock_gpioa));
+    memset(&mock_spi1, 0, sizeof(mock_spi1));
+    memset(&mock_dma2, 0, sizeof(mock_dma2));
+    memset(&mock_dma2_stream1, 0, sizeof(mock_dma2_stream1));
+    memset(&mock_dma2_stream3, 0, sizeof(mock_dma2_stream3));
+    memset(&mock_crc, 0, sizeof(mock_crc));
+    memset(&mock_dwt, 0, sizeof(mock_dwt));
+    memset(mock_nvic_enabled, 0, sizeof(mock_nvic_enabled));
+
+    // An idle SPI1 with an empty transmit buffer
+    mock_spi1.SR = SPI_SR_TXE;
+}
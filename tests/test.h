@@ -0,0 +1,48 @@
+/**
+ *  @file   test.h
+ *  @author Adom Kwabena
+ *  @brief  Checks shared by the host tests. Every test is its own program,
+ *          which prints the failed checks and exits with a non-zero status
+ *          if any check failed.
+ */
+
+// Prevent multiple file inclusion
+#ifndef __TEST_INC__
+#define __TEST_INC__
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdio.h>
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+static unsigned int g_test_checks = 0;
+static unsigned int g_test_failures = 0;
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// Records a check, printing it if the condition does not hold
+#define TEST_CHECK(condition)                                               \
+    do                                                                      \
+    {                                                                       \
+        g_test_checks++;                                                    \
+        if (!(condition))                                                   \
+        {                                                                   \
+            g_test_failures++;                                              \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__,        \
+                   #condition);                                             \
+        }                                                                   \
+    } while (0)
+
+// Prints a summary, the value is the exit status of the test
+#define TEST_RESULT(name)                                                   \
+    (printf("%s: %u checks, %u failed\n", (name), g_test_checks,            \
+            g_test_failures), (g_test_failures != 0))
+
+#endif
@@ -0,0 +1,187 @@
+/**
+ *  @file   test_spi1_dma.c
+ *  @author Adom Kwabena
+ *  @brief  Host test of the SPI1 DMA transmit routines against mocked
+ *          SPI1 and DMA2 register blocks. The test plays the part of the
+ *          DMA controller by raising the stream interrupt flags.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+#include "stm32f407xx.h"
+#include "spi1.h"
+#include "test.h"
+
+// ****************************************************************************
+// * Function Prototypes
+// ****************************************************************************
+
+// Interrupt handler of the SPI1_TX stream, normally reached from the
+// vector table
+void DMA2_Stream3_IRQHandler(void);
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+static uint8_t g_buffer[8192];
+static uint32_t g_callbacks = 0;
+
+// ****************************************************************************
+// * Private Functions
+// ****************************************************************************
+
+/**
+ *  @brief   Counts completion callbacks.
+ *  @param   None.
+ *  @returns None.
+ */
+static void transfer_complete(void)
+{
+    g_callbacks++;
+}
+
+/**
+ *  @brief   Completes the transfer in flight the way the hardware does:
+ *           the stream raises its transfer complete flag and the stream
+ *           interrupt is taken.
+ *  @param   None.
+ *  @returns None.
+ */
+static void complete_transfer(void)
+{
+    SPI_TX_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+    SPI_TX_DMA->LISR = SPI_TX_DMA_TC_FLAG;
+    DMA2_Stream3_IRQHandler();
+}
+
+/**
+ *  @brief   Checks the stream setup done by "spi1_dma_init()".
+ *  @param   None.
+ *  @returns None.
+ */
+static void test_init(void)
+{
+    uint32_t cr = SPI_TX_DMA_STREAM->CR;
+
+    TEST_CHECK(RCC->AHB1ENR & RCC_AHB1ENR_DMA2EN);
+    TEST_CHECK(((cr & DMA_SxCR_CHSEL) >> DMA_SxCR_CHSEL_Pos) == SPI_TX_DMA_CHANNEL);
+    // Memory to peripheral
+    TEST_CHECK((cr & DMA_SxCR_DIR) == DMA_SxCR_DIR_0);
+    TEST_CHECK((cr & (DMA_SxCR_MSIZE | DMA_SxCR_PSIZE)) == 0);
+    TEST_CHECK((cr & DMA_SxCR_PL) == DMA_SxCR_PL_1);
+    TEST_CHECK(cr & DMA_SxCR_TCIE);
+    TEST_CHECK(cr & DMA_SxCR_TEIE);
+    TEST_CHECK((cr & DMA_SxCR_EN) == 0);
+    TEST_CHECK((SPI_TX_DMA_STREAM->FCR & DMA_SxFCR_DMDIS) == 0);
+    TEST_CHECK(SPI_TX_DMA_STREAM->PAR == (uint32_t) (uintptr_t) &SPI_INSTANCE->DR);
+    TEST_CHECK(SPI_TX_DMA_IFCR == SPI_TX_DMA_CLEAR_FLAGS);
+    TEST_CHECK(mock_nvic_enabled[SPI_TX_DMA_IRQ >> 5] & (1UL << (SPI_TX_DMA_IRQ & 0x1F)));
+    TEST_CHECK(!spi1_dma_busy());
+}
+
+/**
+ *  @brief   Checks a buffer transfer from start to completion.
+ *  @param   None.
+ *  @returns None.
+ */
+static void test_buffer(void)
+{
+    SPI_TX_DMA_IFCR = 0;
+    g_callbacks = 0;
+
+    spi1_transmit_buffer_dma(g_buffer, sizeof(g_buffer), transfer_complete);
+
+    TEST_CHECK(spi1_dma_busy());
+    TEST_CHECK(SPI_TX_DMA_IFCR == SPI_TX_DMA_CLEAR_FLAGS);
+    TEST_CHECK(SPI_TX_DMA_STREAM->M0AR == (uint32_t) (uintptr_t) g_buffer);
+    TEST_CHECK(SPI_TX_DMA_STREAM->NDTR == sizeof(g_buffer));
+    TEST_CHECK(SPI_TX_DMA_STREAM->CR & DMA_SxCR_MINC);
+    TEST_CHECK((SPI_TX_DMA_STREAM->CR & (DMA_SxCR_MSIZE | DMA_SxCR_PSIZE)) == 0);
+    TEST_CHECK(SPI_TX_DMA_STREAM->CR & DMA_SxCR_EN);
+    TEST_CHECK(SPI_INSTANCE->CR2 & SPI_CR2_TXDMAEN);
+    TEST_CHECK(g_callbacks == 0);
+
+    // An interrupt without a completion flag is ignored
+    SPI_TX_DMA->LISR = 0;
+    DMA2_Stream3_IRQHandler();
+    TEST_CHECK(spi1_dma_busy());
+    TEST_CHECK(g_callbacks == 0);
+
+    complete_transfer();
+
+    TEST_CHECK(!spi1_dma_busy());
+    TEST_CHECK(g_callbacks == 1);
+    TEST_CHECK((SPI_INSTANCE->CR2 & SPI_CR2_TXDMAEN) == 0);
+    TEST_CHECK(SPI_TX_DMA_IFCR == SPI_TX_DMA_CLEAR_FLAGS);
+}
+
+/**
+ *  @brief   Checks the memory address and transfer size modes of the
+ *           repeat and 16-bit transfers, and a transfer error.
+ *  @param   None.
+ *  @returns None.
+ */
+static void test_modes(void)
+{
+    static uint16_t frame = 0xA5A5;
+
+    g_callbacks = 0;
+
+    // The same byte over and over
+    spi1_transmit_repeat_dma(g_buffer, 100, NULL);
+    TEST_CHECK((SPI_TX_DMA_STREAM->CR & DMA_SxCR_MINC) == 0);
+    TEST_CHECK(SPI_TX_DMA_STREAM->NDTR == 100);
+    complete_transfer();
+    TEST_CHECK(!spi1_dma_busy());
+
+    // Halfwords on both sides
+    spi1_transmit_buffer16_dma((const uint16_t *) g_buffer, 4096, transfer_complete);
+    TEST_CHECK(SPI_TX_DMA_STREAM->CR & DMA_SxCR_MINC);
+    TEST_CHECK((SPI_TX_DMA_STREAM->CR & (DMA_SxCR_MSIZE | DMA_SxCR_PSIZE)) ==
+               (DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0));
+    TEST_CHECK(SPI_TX_DMA_STREAM->NDTR == 4096);
+    complete_transfer();
+
+    spi1_transmit_repeat16_dma(&frame, 10, transfer_complete);
+    TEST_CHECK((SPI_TX_DMA_STREAM->CR & DMA_SxCR_MINC) == 0);
+    TEST_CHECK((SPI_TX_DMA_STREAM->CR & (DMA_SxCR_MSIZE | DMA_SxCR_PSIZE)) ==
+               (DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0));
+    TEST_CHECK(SPI_TX_DMA_STREAM->M0AR == (uint32_t) (uintptr_t) &frame);
+
+    // A transfer error releases the stream as well, but is reported
+    TEST_CHECK(!spi1_dma_error());
+    SPI_TX_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+    SPI_TX_DMA->LISR = SPI_TX_DMA_TE_FLAG;
+    DMA2_Stream3_IRQHandler();
+    TEST_CHECK(!spi1_dma_busy());
+    TEST_CHECK(g_callbacks == 2);
+    TEST_CHECK(spi1_dma_error());
+
+    // Back to byte transfers, which clears the error
+    spi1_transmit_buffer_dma(g_buffer, 16, NULL);
+    TEST_CHECK(!spi1_dma_error());
+    TEST_CHECK((SPI_TX_DMA_STREAM->CR & (DMA_SxCR_MSIZE | DMA_SxCR_PSIZE)) == 0);
+    complete_transfer();
+    TEST_CHECK(!spi1_dma_error());
+}
+
+// ****************************************************************************
+// * Test Entry
+// ****************************************************************************
+
+int main(void)
+{
+    mock_registers_reset();
+
+    spi1_dma_init();
+
+    test_init();
+    test_buffer();
+    test_modes();
+
+    return TEST_RESULT("test_spi1_dma");
+}
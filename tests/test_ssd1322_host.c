@@ -0,0 +1,509 @@
+/**
+ *  @file   test_ssd1322_host.c
+ *  @author Adom Kwabena
+ *  @brief  Host test of the ssd1322 driver. The driver talks to the host
+ *          memory sink, and the GDDRAM image collected by the sink is
+ *          compared with the frame buffers drawn.
+ */
+
+// ****************************************************************************
+// * Included Files
+// ****************************************************************************
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1322.h"
+#include "ssd1322_marquee.h"
+#include "ssd1322_transport.h"
+#include "test.h"
+
+// ****************************************************************************
+// * Definitions and Macros
+// ****************************************************************************
+
+// First GDDRAM byte of a display row
+#define FIRST_BYTE      (DISPLAY_COLUMN_START * 2U)
+// Surface wider than the blend row buffer and past column 511
+#define WIDE_WIDTH      600U
+#define WIDE_HEIGHT     2U
+
+// ****************************************************************************
+// * Module Global Variables
+// ****************************************************************************
+
+static uint8_t g_fb[BUFFER_SIZE];
+static uint8_t g_expected[BUFFER_SIZE];
+static uint8_t g_resource[16 * 24];
+static uint32_t g_callbacks = 0;
+
+// ****************************************************************************
+// * Private Functions
+// ****************************************************************************
+
+/**
+ *  @brief   Counts completion callbacks.
+ *  @param   None.
+ *  @returns None.
+ */
+static void transfer_complete(void)
+{
+    g_callbacks++;
+}
+
+/**
+ *  @brief   Checks if the page being displayed holds a frame buffer.
+ *  @param   fb: The frame buffer.
+ *  @returns 1 if every row matches, 0 otherwise.
+ */
+static uint8_t gddram_matches(const uint8_t *fb)
+{
+    const ssd1322_host_sink_t *sink = ssd1322_host_sink();
+    uint8_t page_row = ssd1322_get_page_row();
+
+    for (uint8_t y = 0; y < BUFFER_HEIGHT; y++)
+    {
+        if (memcmp(&sink->gddram[page_row + y][FIRST_BYTE],
+                   fb + (y * BUFFER_WIDTH), BUFFER_WIDTH) != 0)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ *  @brief   Reads a pixel of a block of pixels.
+ *  @param   pixels: The first byte of the top row.
+ *  @param   stride: The bytes between the start of two rows.
+ *  @param   x: The pixel column.
+ *  @param   y: The pixel row.
+ *  @returns The gray level.
+ */
+static uint8_t get_pixel_stride(const uint8_t *pixels, uint32_t stride,
+                                uint32_t x, uint32_t y)
+{
+    uint8_t byte = pixels[(y * stride) + (x >> 1)];
+
+    return (x & 0x01) ? (byte & 0x0F) : (byte >> 4);
+}
+
+/**
+ *  @brief   Writes a pixel of a block of pixels.
+ *  @param   pixels: The first byte of the top row.
+ *  @param   stride: The bytes between the start of two rows.
+ *  @param   x: The pixel column.
+ *  @param   y: The pixel row.
+ *  @param   level: The gray level.
+ *  @returns None.
+ */
+static void set_pixel_stride(uint8_t *pixels, uint32_t stride,
+                             uint32_t x, uint32_t y, uint8_t level)
+{
+    uint8_t *byte = &pixels[(y * stride) + (x >> 1)];
+
+    *byte = (x & 0x01) ? ((*byte & 0xF0) | level) : ((*byte & 0x0F) | (level << 4));
+}
+
+/**
+ *  @brief   Reads a pixel of a frame buffer.
+ *  @param   fb: The frame buffer.
+ *  @param   x: The pixel column.
+ *  @param   y: The pixel row.
+ *  @returns The gray level.
+ */
+static uint8_t get_pixel(const uint8_t *fb, uint32_t x, uint32_t y)
+{
+    return get_pixel_stride(fb, BUFFER_WIDTH, x, y);
+}
+
+/**
+ *  @brief   Writes a pixel of a frame buffer.
+ *  @param   fb: The frame buffer.
+ *  @param   x: The pixel column.
+ *  @param   y: The pixel row.
+ *  @param   level: The gray level.
+ *  @returns None.
+ */
+static void set_pixel(uint8_t *fb, uint32_t x, uint32_t y, uint8_t level)
+{
+    set_pixel_stride(fb, BUFFER_WIDTH, x, y, level);
+}
+
+/**
+ *  @brief   Blends one pixel the way the driver documents it.
+ *  @param   mode: The blend mode.
+ *  @param   dst: The frame buffer pixel.
+ *  @param   src: The resource pixel.
+ *  @param   weight: The alpha weight out of 16.
+ *  @param   key: The transparent gray level.
+ *  @returns The blended pixel.
+ */
+static uint8_t blend_pixel(uint8_t mode, uint8_t dst, uint8_t src,
+                           uint8_t weight, uint8_t key)
+{
+    switch (mode)
+    {
+        case BLEND_OR:
+            return dst | src;
+        case BLEND_XOR:
+            return dst ^ src;
+        case BLEND_MAX:
+            return (dst > src) ? dst : src;
+        case BLEND_ADD:
+            return (dst + src > 15) ? 15 : (dst + src);
+        case BLEND_ALPHA:
+            if (src == key)
+            {
+                return dst;
+            }
+            return (uint8_t) ((src * weight + dst * (16 - weight) + 8) >> 4);
+        default:
+            return src;
+    }
+}
+
+/**
+ *  @brief   Checks initialization and whole frame uploads.
+ *  @param   None.
+ *  @returns None.
+ */
+static void test_display(void)
+{
+    const ssd1322_host_sink_t *sink = ssd1322_host_sink();
+
+    ssd1322_initialize();
+
+    TEST_CHECK(sink->resets == 1);
+    TEST_CHECK(sink->start_line == 0);
+    TEST_CHECK(sink->command_bytes > 0);
+
+    for (uint32_t i = 0; i < BUFFER_SIZE; i++)
+    {
+        g_fb[i] = (uint8_t) rand();
+    }
+
+    ssd1322_display_fb(g_fb);
+    TEST_CHECK(gddram_matches(g_fb));
+
+    // Orientations select the re-map format, mirroring keeps the columns
+    TEST_CHECK(sink->remap_format == REMAP_DEFAULT);
+    ssd1322_set_orientation(ORIENTATION_MIRROR_X);
+    TEST_CHECK(sink->remap_format == (REMAP_DEFAULT | REMAP_COLUMN));
+    TEST_CHECK(ssd1322_get_column_offset() == DISPLAY_COLUMN_START);
+    ssd1322_set_orientation(ORIENTATION_ROTATE_180);
+    TEST_CHECK(sink->remap_format ==
+               (REMAP_DEFAULT ^ (REMAP_COLUMN | REMAP_COM_SCAN)));
+    ssd1322_set_orientation(ORIENTATION_NORMAL);
+    TEST_CHECK(sink->remap_format == REMAP_DEFAULT);
+
+    // Asynchronous uploads complete before returning on the host
+    ssd1322_fill_fb(g_fb, 0x5A);
+    ssd1322_display_fb_async(g_fb, transfer_complete);
+    TEST_CHECK(g_callbacks == 1);
+    TEST_CHECK(!ssd1322_display_fb_busy());
+    TEST_CHECK(gddram_matches(g_fb));
+
+    // Flips are sent from thread context, not by the completion handler
+    ssd1322_set_page_flip(1);
+    ssd1322_fill_fb(g_fb, 0xA5);
+    ssd1322_display_fb_async(g_fb, transfer_complete);
+    TEST_CHECK(g_callbacks == 2);
+    TEST_CHECK(sink->start_line == 0);
+    TEST_CHECK(!ssd1322_display_fb_busy());
+    TEST_CHECK(sink->start_line == BUFFER_HEIGHT);
+    TEST_CHECK(ssd1322_get_page_row() == BUFFER_HEIGHT);
+    TEST_CHECK(gddram_matches(g_fb));
+
+    // Initializing again drops a flip left pending by a transfer
+    ssd1322_display_fb_async(g_fb, NULL);
+    ssd1322_initialize();
+    TEST_CHECK(ssd1322_get_page_row() == 0);
+    TEST_CHECK(sink->start_line == 0);
+    ssd1322_set_page_flip(0);
+}
+
+/**
+ *  @brief   Checks dirty rectangle and content-diff flushes.
+ *  @param   None.
+ *  @returns None.
+ */
+static void test_partial(void)
+{
+    const ssd1322_host_sink_t *sink = ssd1322_host_sink();
+    ssd1322_diff_stats_t stats;
+
+    ssd1322_fill_fb(g_fb, 0x00);
+    ssd1322_display_fb(g_fb);
+
+    // Only the bytes around the drawing are sent
+    uint32_t data_bytes = sink->data_bytes;
+
+    ssd1322_put_rectangle_fb(g_fb, 10, 20, 30, 40);
+    ssd1322_put_pixel_fb(g_fb, 201, 5);
+
+    uint32_t sent = ssd1322_flush_dirty_fb(g_fb);
+
+    TEST_CHECK(gddram_matches(g_fb));
+    TEST_CHECK(sent < BUFFER_SIZE / 4);
+    // Each window also takes 4 bytes of address arguments
+    TEST_CHECK(sink->data_bytes - data_bytes >= sent);
+    TEST_CHECK(sink->data_bytes - data_bytes <= sent + (4 * SSD1322_DIRTY_RECTS));
+
+    // The first content-diff flush sends everything, the next one only
+    // the segments which changed
+    ssd1322_flush_diff_fb(g_fb);
+    ssd1322_get_diff_stats(&stats);
+    TEST_CHECK(stats.rows_sent == BUFFER_HEIGHT);
+
+    ssd1322_flush_diff_fb(g_fb);
+    ssd1322_get_diff_stats(&stats);
+    TEST_CHECK(stats.rows_sent == 0);
+    TEST_CHECK(stats.bytes_sent == 0);
+
+    g_fb[(33 * BUFFER_WIDTH) + 100] = 0x77;
+    ssd1322_flush_diff_fb(g_fb);
+    ssd1322_get_diff_stats(&stats);
+    TEST_CHECK(stats.rows_sent == 1);
+    TEST_CHECK(stats.bytes_sent == SSD1322_DIFF_SEGMENT_BYTES);
+    TEST_CHECK(gddram_matches(g_fb));
+
+    // Any other write into GDDRAM makes the next content-diff flush send
+    // everything again
+    memcpy(g_expected, g_fb, BUFFER_SIZE);
+    ssd1322_fill_fb(g_expected, 0x55);
+    ssd1322_flush_dirty_fb(g_expected);
+    TEST_CHECK(gddram_matches(g_expected));
+
+    ssd1322_flush_diff_fb(g_fb);
+    ssd1322_get_diff_stats(&stats);
+    TEST_CHECK(stats.rows_sent == BUFFER_HEIGHT);
+    TEST_CHECK(gddram_matches(g_fb));
+}
+
+/**
+ *  @brief   Checks every blend mode at even and odd pixel columns against
+ *           a pixel at a time reference, then uploads the result.
+ *  @param   None.
+ *  @returns None.
+ */
+static void test_blend(void)
+{
+    const uint8_t columns = 16;
+    const uint8_t rows = 24;
+    const uint8_t alpha = 9;
+    const uint8_t key = 3;
+    const uint8_t weight = alpha + (alpha >> 3);
+
+    for (uint32_t i = 0; i < sizeof(g_resource); i++)
+    {
+        g_resource[i] = (uint8_t) rand();
+    }
+
+    ssd1322_set_blend_alpha(alpha, key);
+
+    for (uint8_t mode = BLEND_COPY; mode <= BLEND_ALPHA; mode++)
+    {
+        for (int16_t x = 37; x <= 38; x++)
+        {
+            for (uint32_t i = 0; i < BUFFER_SIZE; i++)
+            {
+                g_fb[i] = (uint8_t) rand();
+            }
+            memcpy(g_expected, g_fb, BUFFER_SIZE);
+
+            for (uint8_t y = 0; y < rows; y++)
+            {
+                for (uint8_t j = 0; j < columns * 2; j++)
+                {
+                    uint8_t byte = g_resource[(y * columns) + (j >> 1)];
+                    uint8_t src = (j & 0x01) ? (byte & 0x0F) : (byte >> 4);
+                    uint8_t dst = get_pixel(g_expected, x + j, 10 + y);
+
+                    set_pixel(g_expected, x + j, 10 + y,
+                              blend_pixel(mode, dst, src, weight, key));
+                }
+            }
+
+            ssd1322_set_blend_mode(mode);
+            ssd1322_put_resource_fb(g_fb, x, 10, rows, columns, g_resource);
+
+            TEST_CHECK(memcmp(g_fb, g_expected, BUFFER_SIZE) == 0);
+        }
+    }
+
+    ssd1322_set_blend_mode(BLEND_COPY);
+
+    ssd1322_display_fb(g_fb);
+    TEST_CHECK(gddram_matches(g_fb));
+}
+
+/**
+ *  @brief   Checks a rectangle drawn straight into the GDDRAM against the
+ *           same rectangle drawn into a frame buffer.
+ *  @param   None.
+ *  @returns None.
+ */
+static void test_immediate(void)
+{
+    ssd1322_fill_fb(g_fb, IMMEDIATE_BACKGROUND);
+    ssd1322_display_fb(g_fb);
+
+    // Tall edges with a different byte on either side of the column
+    ssd1322_put_rectangle(11, 1, 40, 62);
+    ssd1322_put_rectangle_fb(g_fb, 11, 1, 40, 62);
+    TEST_CHECK(gddram_matches(g_fb));
+}
+
+/**
+ *  @brief   Checks blending into surfaces wider than the display, and that
+ *           only frame buffer surfaces record dirty regions.
+ *  @param   None.
+ *  @returns None.
+ */
+static void test_surface(void)
+{
+    static uint8_t wide[WIDE_HEIGHT * (WIDE_WIDTH / 2)];
+    static uint8_t wide_expected[WIDE_HEIGHT * (WIDE_WIDTH / 2)];
+    static uint8_t source[WIDE_HEIGHT * ((WIDE_WIDTH - 40) / 2)];
+    static uint8_t *wide_rows[WIDE_HEIGHT];
+    static uint8_t *source_rows[WIDE_HEIGHT];
+    static uint8_t *fb_rows[BUFFER_HEIGHT];
+    ssd1322_surface_t surface;
+    ssd1322_surface_t sprite;
+
+    for (uint32_t i = 0; i < sizeof(wide); i++)
+    {
+        wide[i] = (uint8_t) rand();
+    }
+    for (uint32_t i = 0; i < sizeof(source); i++)
+    {
+        source[i] = (uint8_t) rand();
+    }
+    memcpy(wide_expected, wide, sizeof(wide));
+
+    ssd1322_surface_init(&surface, wide, wide_rows, WIDE_WIDTH, WIDE_HEIGHT, WIDE_WIDTH / 2);
+    ssd1322_surface_init(&sprite, source, source_rows, WIDE_WIDTH - 40,
+                         WIDE_HEIGHT, (WIDE_WIDTH - 40) / 2);
+
+    // An odd column shifts every pixel, far past the width of the display
+    for (uint32_t y = 0; y < WIDE_HEIGHT; y++)
+    {
+        for (uint32_t x = 0; x < WIDE_WIDTH - 40; x++)
+        {
+            uint8_t src = get_pixel_stride(source, (WIDE_WIDTH - 40) / 2, x, y);
+            uint8_t dst = get_pixel_stride(wide_expected, WIDE_WIDTH / 2, x + 21, y);
+
+            set_pixel_stride(wide_expected, WIDE_WIDTH / 2, x + 21, y,
+                             blend_pixel(BLEND_ADD, dst, src, 16, 0));
+        }
+    }
+
+    ssd1322_set_blend_mode(BLEND_ADD);
+    ssd1322_surface_put_surface(&surface, 21, 0, &sprite);
+    ssd1322_set_blend_mode(BLEND_COPY);
+    TEST_CHECK(memcmp(wide, wide_expected, sizeof(wide)) == 0);
+
+    // Pixels past column 511
+    ssd1322_surface_fill(&surface, 0x00);
+    ssd1322_surface_put_pixel(&surface, WIDE_WIDTH - 1, 1);
+    TEST_CHECK(get_pixel_stride(wide, WIDE_WIDTH / 2, WIDE_WIDTH - 1, 1) == 0x0F);
+    TEST_CHECK(get_pixel_stride(wide, WIDE_WIDTH / 2, (WIDE_WIDTH - 1) & 0x1FF, 1) == 0x00);
+
+    // Lines and rectangles past byte column 255
+    ssd1322_surface_fill(&surface, 0x00);
+    ssd1322_surface_put_vertical_line(&surface, 280, 0, WIDE_HEIGHT, ALIGN_RIGHT);
+    TEST_CHECK(wide[280] == 0x0F);
+    TEST_CHECK(wide[(WIDE_WIDTH / 2) + 280] == 0x0F);
+    TEST_CHECK(wide[280 & 0xFF] == 0x00);
+
+    ssd1322_surface_fill(&surface, 0x00);
+    ssd1322_surface_put_rectangle(&surface, 260, 0, 290, WIDE_HEIGHT - 1);
+
+    uint32_t drawn = 0;
+
+    for (uint32_t i = 0; i < sizeof(wide); i++)
+    {
+        drawn += (wide[i] != 0x00);
+    }
+
+    TEST_CHECK(drawn == WIDE_HEIGHT * 31);
+    TEST_CHECK(wide[260] == 0xFF);
+    TEST_CHECK(wide[(WIDE_WIDTH / 2) + 290] == 0xFF);
+
+    // Off-screen surfaces, even the size of the display, are not flushed
+    ssd1322_fill_fb(g_fb, 0x00);
+    ssd1322_display_fb(g_fb);
+    ssd1322_surface_init(&surface, g_expected, fb_rows, DISPLAY_WIDTH, BUFFER_HEIGHT, BUFFER_WIDTH);
+    ssd1322_surface_put_pixel(&surface, 3, 3);
+    TEST_CHECK(ssd1322_flush_dirty_fb(g_fb) == 0);
+
+    ssd1322_surface_init_fb(&surface, g_fb, fb_rows);
+    ssd1322_surface_put_pixel(&surface, 3, 3);
+    TEST_CHECK(ssd1322_flush_dirty_fb(g_fb) > 0);
+    TEST_CHECK(gddram_matches(g_fb));
+}
+
+/**
+ *  @brief   Checks the ring width and band height a marquee accepts.
+ *  @param   None.
+ *  @returns None.
+ */
+static void test_marquee(void)
+{
+    const ssd1322_host_sink_t *sink = ssd1322_host_sink();
+    static font_table_entry_t table[MARQUEE_GLYPHS];
+    static const uint8_t glyph = 0xFF;
+    static uint8_t strip[4 * ((DISPLAY_WIDTH + 48) / 2)];
+    const font_t font = { &glyph, table, 1, 0 };
+    ssd1322_marquee_t marquee;
+
+    // Every glyph is a 2 pixel dash, 'W' advances wider than the gap
+    for (uint32_t i = 0; i < MARQUEE_GLYPHS; i++)
+    {
+        table[i] = (font_table_entry_t) { 0, 1, 1, 0, 0, 8 };
+    }
+    table['W' - ' '].glyph_advance_width = MARQUEE_GAP + 8;
+
+    ssd1322_set_font(&font);
+
+    // The ring holds the display plus the widest glyph
+    TEST_CHECK(!ssd1322_marquee_init(&marquee, strip, DISPLAY_WIDTH + MARQUEE_GAP, 4, 0));
+    TEST_CHECK(ssd1322_marquee_init(&marquee, strip, DISPLAY_WIDTH + MARQUEE_GAP + 8, 4, 0));
+
+    // Empty bands are rejected and never drawn
+    uint32_t data_bytes = sink->data_bytes;
+
+    TEST_CHECK(!ssd1322_marquee_init(&marquee, strip, DISPLAY_WIDTH + 48, 0, 10));
+    ssd1322_marquee_set_text(&marquee, "WWW");
+    ssd1322_marquee_step(&marquee, 8);
+    TEST_CHECK(sink->data_bytes == data_bytes);
+
+    // Only the rows of the band are uploaded
+    TEST_CHECK(ssd1322_marquee_init(&marquee, strip, DISPLAY_WIDTH + 48, 4, 10));
+    ssd1322_marquee_set_text(&marquee, "WWW");
+    ssd1322_marquee_step(&marquee, 8);
+    TEST_CHECK(sink->data_bytes - data_bytes >= 4 * BUFFER_WIDTH);
+    TEST_CHECK(sink->data_bytes - data_bytes <= (4 * BUFFER_WIDTH) + 4);
+
+    ssd1322_set_font(NULL);
+}
+
+// ****************************************************************************
+// * Test Entry
+// ****************************************************************************
+
+int main(void)
+{
+    srand(1);
+
+    test_display();
+    test_partial();
+    test_blend();
+    test_immediate();
+    test_surface();
+    test_marquee();
+
+    return TEST_RESULT("test_ssd1322_host");
+}